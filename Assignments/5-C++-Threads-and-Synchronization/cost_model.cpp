@@ -0,0 +1,245 @@
+#include <algorithm>    // std::min, std::max
+#include <chrono>       /* time manipulation */
+#include <fstream>
+#include <functional>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>     // gethostname
+
+/*
+    Cost model that decides, per call, whether a kernel should run sequentially or in parallel,
+    and with how many threads.
+
+    For a kernel with a sequential cost of c seconds per unit of work, and a backend whose
+    parallel launch (fork, or spawn, plus join) costs a + b * p seconds for p threads,
+        T(n, 1) = n * c
+        T(n, p) = n * c / p + a + b * p
+    and the dispatcher picks the p in [1, max_threads] that minimizes T(n, p).
+
+    a and b are fitted from timings of empty parallel regions, c from timings of the sequential
+    kernel on a sample input.  All of the parameters can be saved to and loaded from a cache file
+    of "name value" lines, so that only the first run of a program pays for calibration.  The names
+    start with the host name, and the backend parameters also with max_threads, e.g.
+        node7/8/openmp.fixed    node7/maxima.per_unit
+    so a cache copied to another machine, or reused with a different thread limit, is recalibrated
+    instead of trusted.
+*/
+
+const int CALIBRATION_REPETITIONS = 20;
+
+class CostModel {
+
+public:
+
+    /**
+     * @description: constructor, loads any parameters already in the cache file
+     * @param {std::string} cache_file: path of the cache file, may not exist yet
+     * @param {int} max_threads: the largest number of threads the dispatcher may choose
+     */
+    CostModel(const std::string& cache_file, int max_threads) :
+        cache_file(cache_file),
+        host(host_name()),
+        max_threads(std::max(1, max_threads)) {
+        load();
+    }
+
+    /**
+     * @description: fit the launch cost a + b * p of a parallel backend, unless it is already known
+     * @param {std::string} backend: name of the backend, e.g. "std::thread" or "openmp"
+     * @param {std::function<void(int)>} launch: runs one empty parallel region with the given number of threads
+     */
+    void calibrate_backend(const std::string& backend, const std::function<void(int)>& launch) {
+        if ( backend_calibrated(backend) ) {
+            return;
+        }
+        // least-squares line through the best-of-N launch time at p = 2, 4, 8, ..., max_threads
+        std::vector<double> xs;
+        std::vector<double> ys;
+        for ( int p = 2; p < max_threads; p *= 2 ) {
+            xs.push_back(p);
+        }
+        if ( max_threads > 1 ) {
+            xs.push_back(max_threads);
+        }
+        if ( max_threads == 2 ) {
+            xs.push_back(4);    // empty regions may oversubscribe, so that two threads still give a line
+        }
+        if ( xs.size() < 2 ) {
+            return;     // one thread: nothing to fit, and choose_threads stays sequential
+        }
+        for ( double p : xs ) {
+            ys.push_back(best_time([&launch, p]() { launch((int)p); }));
+        }
+        double mean_x = 0;
+        double mean_y = 0;
+        for ( size_t i = 0; i < xs.size(); i++ ) {
+            mean_x += xs[i] / xs.size();
+            mean_y += ys[i] / ys.size();
+        }
+        double covariance = 0;
+        double variance = 0;
+        for ( size_t i = 0; i < xs.size(); i++ ) {
+            covariance += (xs[i] - mean_x) * (ys[i] - mean_y);
+            variance += (xs[i] - mean_x) * (xs[i] - mean_x);
+        }
+        double per_thread = variance > 0 ? std::max(0.0, covariance / variance) : 0.0;
+        parameters[backend_parameter(backend, "fixed")] = std::max(0.0, mean_y - per_thread * mean_x);
+        parameters[backend_parameter(backend, "per_thread")] = per_thread;
+    }
+
+    /**
+     * @description: measure the sequential cost per unit of work of a kernel, unless it is already known
+     * @param {std::string} kernel: name of the kernel, e.g. "maxima"
+     * @param {double} work: units of work done by one call of run
+     * @param {std::function<void()>} run: runs the sequential kernel once on a sample input
+     */
+    void calibrate_kernel(const std::string& kernel, double work, const std::function<void()>& run) {
+        if ( parameters.count(kernel_parameter(kernel)) ) {
+            return;
+        }
+        run();      // warm up caches and page in the sample
+        parameters[kernel_parameter(kernel)] = best_time(run) / work;
+    }
+
+    /**
+     * @description: choose the number of threads for one call
+     * @param {std::string} backend: a calibrated backend
+     * @param {std::string} kernel: a calibrated kernel
+     * @param {double} work: units of work in this call
+     * @param {int} num_of_launches: the number of parallel regions the call opens, each paying the launch cost
+     * @return {int} 1 to run sequentially, otherwise the number of threads that minimizes the modeled time;
+     *                 1 if the backend has no calibration for this host and max_threads
+     */
+    int choose_threads(const std::string& backend, const std::string& kernel, double work,
+                       int num_of_launches = 1) const {
+        if ( !backend_calibrated(backend) ) {
+            return 1;
+        }
+        const double per_unit = get(kernel_parameter(kernel));
+        const double fixed = get(backend_parameter(backend, "fixed"));
+        const double per_thread = get(backend_parameter(backend, "per_thread"));
+        const double sequential_time = work * per_unit;
+        int best_threads = 1;
+        double best_time = sequential_time;
+        for ( int p = 2; p <= max_threads; p++ ) {
+            double time = sequential_time / p + num_of_launches * (fixed + per_thread * p);
+            if ( time < best_time ) {
+                best_time = time;
+                best_threads = p;
+            }
+        }
+        return best_threads;
+    }
+
+    /**
+     * @description: write every parameter to the cache file
+     * @return {bool} true if the file was written
+     */
+    bool save() const {
+        std::ofstream file(cache_file);
+        if ( !file ) {
+            return false;
+        }
+        file.precision(17);
+        for ( const auto& parameter : parameters ) {
+            file << parameter.first << " " << parameter.second << "\n";
+        }
+        return bool(file);
+    }
+
+    /**
+     * @description: get a parameter by its full name, 0 if it has neither been calibrated nor loaded
+     */
+    double get(const std::string& name) const {
+        auto it = parameters.find(name);
+        return it == parameters.end() ? 0.0 : it->second;
+    }
+
+    int get_max_threads() const {
+        return max_threads;
+    }
+
+    /**
+     * @description: the full name of a backend parameter, for this host and max_threads
+     * @param {std::string} field: "fixed" or "per_thread"
+     */
+    std::string backend_parameter(const std::string& backend, const std::string& field) const {
+        return host + "/" + std::to_string(max_threads) + "/" + backend + "." + field;
+    }
+
+    /**
+     * @description: the full name of the per-unit cost of a kernel, for this host
+     */
+    std::string kernel_parameter(const std::string& kernel) const {
+        return host + "/" + kernel + ".per_unit";
+    }
+
+    /**
+     * @description: whether the launch cost of a backend is known for this host and max_threads
+     */
+    bool backend_calibrated(const std::string& backend) const {
+        return parameters.count(backend_parameter(backend, "fixed")) && parameters.count(backend_parameter(backend, "per_thread"));
+    }
+
+private:
+
+    /**
+     * @description: read "name value" lines from the cache file, if it exists
+     */
+    void load() {
+        std::ifstream file(cache_file);
+        std::string name;
+        double value;
+        while ( file >> name >> value ) {
+            parameters[name] = value;
+        }
+    }
+
+    /**
+     * @description: the name of this machine, "localhost" if it is unknown
+     */
+    static std::string host_name() {
+        char name[256] = {0};
+        if ( gethostname(name, sizeof(name) - 1) != 0 || name[0] == 0 ) {
+            return "localhost";
+        }
+        return name;
+    }
+
+    /**
+     * @description: the shortest of CALIBRATION_REPETITIONS timings of f, in seconds
+     */
+    static double best_time(const std::function<void()>& f) {
+        double best = 0;
+        for ( int i = 0; i < CALIBRATION_REPETITIONS; i++ ) {
+            std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+            f();
+            std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start_time;
+            if ( i == 0 || duration.count() < best ) {
+                best = duration.count();
+            }
+        }
+        return best;
+    }
+
+    const std::string cache_file;
+    const std::string host;
+    const int max_threads;
+    std::map<std::string, double> parameters;
+};
+
+
+/**
+ * @description: launch num_of_threads std::threads that do nothing and join them
+ */
+void launch_empty_threads(int num_of_threads) {
+    std::vector<std::thread> threads;
+    for ( int i = 1; i < num_of_threads; i++ ) {
+        threads.emplace_back([]() {});
+    }
+    for ( std::thread& thread : threads ) {
+        thread.join();
+    }
+}
@@ -0,0 +1,150 @@
+#include <vector>
+#include <thread>
+#include <algorithm>    // std::min, std::max
+#include <cstdint>
+
+/*
+    Counter-based random numbers, for filling large inputs in parallel.
+
+    rand() keeps one global state, so the k-th number is only known after the k - 1 before it, and the
+    stream changes with the order in which threads call it. Here the i-th number of a stream is a pure
+    function of (seed, i):
+        key  = mix(seed)
+        x[i] = mix(key + (i + 1) * 0x9E3779B97F4A7C15)
+    where mix is the SplitMix64 finalizer (two xor-shift-multiply rounds). Every thread fills its own
+    contiguous range with no shared state, the loop has no carried dependence and vectorizes (8 lanes of
+    64-bit multiplies with AVX-512), and the array is the same for any number of threads.
+
+    Conversions:
+        random_below(seed, i, bound)    an integer in [0, bound), the top 32 bits scaled by multiply-shift,
+                                        which avoids a division, bound <= 2^32
+        random_uniform(seed, i)         a double in [0, 1) from the top 53 bits
+    random_integers and random_uniforms write the numbers [first, last) of a stream, for example one piece of a
+    larger input, and random_fill_integers and random_fill_uniform fill a whole array with them in parallel.
+    Two arrays filled from the same seed are the same stream; give them different seeds, e.g. seed and seed + 1.
+*/
+
+const uint64_t DEFAULT_RANDOM_SEED{1};
+const long long RANDOM_FILL_GRAIN{1 << 16};     // elements per thread below which fewer threads are used
+const uint64_t RANDOM_INCREMENT{0x9E3779B97F4A7C15ULL};     // 2^64 / golden ratio, the SplitMix64 step
+const double RANDOM_UNIT{1.0 / 9007199254740992.0};   // 2^-53
+
+/**
+ * @description: the SplitMix64 finalizer, a bijection of 64-bit integers
+ */
+inline uint64_t splitmix64_mix(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+/**
+ * @description: the key of the stream of a seed
+ */
+inline uint64_t random_key(uint64_t seed) {
+    return splitmix64_mix(seed + RANDOM_INCREMENT);
+}
+
+/**
+ * @description: the i-th 64-bit number of the stream with the given key
+ */
+inline uint64_t random_bits(uint64_t key, uint64_t i) {
+    return splitmix64_mix(key + (i + 1) * RANDOM_INCREMENT);
+}
+
+/**
+ * @description: the i-th number of the stream of seed, in [0, bound)
+ */
+inline uint32_t random_below(uint64_t seed, uint64_t i, uint64_t bound) {
+    return (uint32_t)(((random_bits(random_key(seed), i) >> 32) * bound) >> 32);
+}
+
+/**
+ * @description: the i-th number of the stream of seed, in [0, 1)
+ */
+inline double random_uniform(uint64_t seed, uint64_t i) {
+    return (random_bits(random_key(seed), i) >> 11) * RANDOM_UNIT;
+}
+
+/**
+ * @description: out[i - first] = low + the i-th number of the stream of seed in [0, high - low), for i in [first, last)
+ * @param {long long} low, high: the range [low, high), with high - low <= 2^32
+ */
+template <typename T>
+inline void random_integers(T* out, long long first, long long last, long long low, long long high, uint64_t seed) {
+    const uint64_t range = (uint64_t)(high - low);
+    const long long count = last - first;
+    // the counter of random_bits, advanced by addition instead of a multiply per number
+    uint64_t counter = random_key(seed) + (first + 1) * RANDOM_INCREMENT;
+    for ( long long i = 0; i < count; i++ ) {
+        out[i] = (T)(low + (long long)((splitmix64_mix(counter) >> 32) * range >> 32));
+        counter += RANDOM_INCREMENT;
+    }
+}
+
+/**
+ * @description: out[i - first] = the i-th number of the stream of seed in [low, high), for i in [first, last)
+ */
+template <typename T>
+inline void random_uniforms(T* out, long long first, long long last, double low, double high, uint64_t seed) {
+    const double scale = (high - low) * RANDOM_UNIT;
+    const long long count = last - first;
+    uint64_t counter = random_key(seed) + (first + 1) * RANDOM_INCREMENT;
+    for ( long long i = 0; i < count; i++ ) {
+        out[i] = (T)(low + (double)(splitmix64_mix(counter) >> 11) * scale);
+        counter += RANDOM_INCREMENT;
+    }
+}
+
+/**
+ * @description: run fill(first, last) on contiguous ranges of [0, n), one per thread
+ * @param {int} num_of_threads: the largest number of threads, fewer for small n
+ */
+template <typename F>
+void parallel_fill_ranges(long long n, int num_of_threads, const F& fill) {
+    const long long threads_needed = (n + RANDOM_FILL_GRAIN - 1) / RANDOM_FILL_GRAIN;
+    const int p = (int)std::max(1LL, std::min((long long)num_of_threads, threads_needed));
+    if ( p == 1 ) {
+        fill(0LL, n);
+        return;
+    }
+    std::vector<std::thread> threads;
+    for ( int t = 0; t < p; t++ ) {
+        // multiples of 16 elements, whole cache lines of 4- or 8-byte elements, so no two threads write the same line
+        const long long first = std::min(n, n * t / p / 16 * 16);
+        const long long last = t == p - 1 ? n : std::min(n, n * (t + 1) / p / 16 * 16);
+        threads.push_back(std::thread(fill, first, last));
+    }
+    for ( std::thread& thread : threads ) {
+        thread.join();
+    }
+}
+
+/**
+ * @description: a[i] = low + the i-th number of the stream of seed in [0, high - low)
+ * @param {T*} a: an array of an integer or floating point type
+ * @param {long long} n: the length of the array
+ * @param {long long} low, high: the range [low, high), with high - low <= 2^32
+ * @param {uint64_t} seed: the seed of the stream
+ * @param {int} num_of_threads: the number of threads
+ */
+template <typename T>
+void random_fill_integers(T* a, long long n, long long low, long long high, uint64_t seed, int num_of_threads) {
+    parallel_fill_ranges(n, num_of_threads, [=](long long first, long long last) {
+        random_integers(a + first, first, last, low, high, seed);
+    });
+}
+
+/**
+ * @description: a[i] = the i-th number of the stream of seed, in [low, high)
+ * @param {T*} a: an array of float or double
+ * @param {long long} n: the length of the array
+ * @param {uint64_t} seed: the seed of the stream
+ * @param {int} num_of_threads: the number of threads
+ */
+template <typename T>
+void random_fill_uniform(T* a, long long n, double low, double high, uint64_t seed, int num_of_threads) {
+    parallel_fill_ranges(n, num_of_threads, [=](long long first, long long last) {
+        random_uniforms(a + first, first, last, low, high, seed);
+    });
+}
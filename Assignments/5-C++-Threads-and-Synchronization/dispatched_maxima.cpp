@@ -0,0 +1,36 @@
+#include <vector>
+
+#include "cost_model.cpp"
+
+/**
+ * @description: calibrate the std::thread launch cost and the sequential maxima kernel, unless they are cached
+ * @param {CostModel&} model: the cost model to calibrate
+ */
+void calibrate_maxima(CostModel& model) {
+    model.calibrate_backend("std::thread", launch_empty_threads);
+
+    const int sample_size = 1 << 16;
+    std::vector<int> sample(sample_size);
+    for ( int i = 0; i < sample_size; i++ ) {
+        sample[i] = (i * 7919) % sample_size;
+    }
+    volatile int sink = 0;
+    model.calibrate_kernel("maxima", sample_size, [&sample, &sink]() {
+        sink = get_maxima_sequential(sample.data(), (int)sample.size());
+    });
+}
+
+/**
+ * @description: get the global maxima sequentially or in parallel, whichever the cost model predicts is faster
+ * @param {int*} array: target array
+ * @param {int} size_of_array: the size of the target array
+ * @param {const CostModel&} model: a cost model calibrated by calibrate_maxima
+ * @return {int} the global maxima of the target array
+ */
+int get_maxima_dispatched(int* array, int size_of_array, const CostModel& model) {
+    int num_of_threads = model.choose_threads("std::thread", "maxima", size_of_array);
+    if ( num_of_threads == 1 ) {
+        return get_maxima_sequential(array, size_of_array);
+    }
+    return get_maxima_reduce(array, size_of_array, num_of_threads);
+}
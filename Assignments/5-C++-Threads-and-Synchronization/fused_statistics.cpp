@@ -0,0 +1,227 @@
+#include <vector>
+#include <queue>        // std::priority_queue
+#include <functional>   // std::greater
+#include <algorithm>    // std::sort, std::min, std::max
+#include <string>
+
+/*
+    Fused reduction: min, max, argmin, argmax, sum, sum of squares, a fixed-bin histogram and the top k values
+    of an int array, all computed in one parallel pass through memory with parallel_reduce.
+
+    Each thread keeps a bounded min-heap of its k largest values; the heaps are merged in the tree combine.
+    Ties in argmin and argmax go to the lowest index, so the result is the same for any number of threads
+    and equal to the separate sequential computations in sequential_statistics.
+*/
+
+const int STAT_MIN = 1 << 0;
+const int STAT_MAX = 1 << 1;
+const int STAT_ARGMIN = 1 << 2;
+const int STAT_ARGMAX = 1 << 3;
+const int STAT_SUM = 1 << 4;
+const int STAT_SUM_OF_SQUARES = 1 << 5;
+const int STAT_HISTOGRAM = 1 << 6;
+const int STAT_TOP_K = 1 << 7;
+const int STAT_ALL = (1 << 8) - 1;
+
+/**
+ * @description: which statistics to compute, and the parameters of the histogram and top-k
+ */
+struct statistics_request {
+    int statistics;         // bitwise or of STAT_* flags
+    int histogram_min;      // the histogram covers [histogram_min, histogram_max) ...
+    int histogram_max;
+    int num_of_bins;        // ... in num_of_bins equal bins; values outside the range are not counted
+    int k;                  // the number of largest values to keep
+};
+
+/**
+ * @description: result of a statistics reduction; only the requested fields are meaningful
+ */
+struct statistics {
+    indexed_value minima;
+    indexed_value maxima;
+    long long sum;
+    unsigned __int128 sum_of_squares;   // up to 2^62 per element, so it needs more than 64 bits
+    std::vector<long long> histogram;
+    std::vector<int> top_k;             // in descending order
+};
+
+
+/**
+ * @description: bin of value in the histogram, or -1 if it is outside of the histogram range
+ */
+inline int histogram_bin(const statistics_request& request, int value) {
+    if ( value < request.histogram_min || value >= request.histogram_max ) {
+        return -1;
+    }
+    long long offset = (long long)value - request.histogram_min;
+    long long range = (long long)request.histogram_max - request.histogram_min;
+    return (int)(offset * request.num_of_bins / range);
+}
+
+/**
+ * @description: parallel_reduce operation computing every requested statistic in one pass
+ */
+struct statistics_op {
+
+    statistics_request request;
+
+    statistics leaf(const int* array, int start, int end) const {
+        const int wanted = request.statistics;
+        statistics result;
+        result.minima = {array[start], start};
+        result.maxima = {array[start], start};
+        result.sum = 0;
+        result.sum_of_squares = 0;
+        if ( wanted & STAT_HISTOGRAM ) {
+            result.histogram.assign(request.num_of_bins, 0);
+        }
+        // min-heap of the k largest values seen so far, its top is the smallest of them
+        std::priority_queue<int, std::vector<int>, std::greater<int>> heap;
+        const size_t k = (wanted & STAT_TOP_K) ? (size_t)std::max(0, request.k) : 0;
+
+        for ( int i = start; i < end; i++ ) {
+            const int value = array[i];
+            if ( value < result.minima.value ) {
+                result.minima = {value, i};
+            }
+            if ( value > result.maxima.value ) {
+                result.maxima = {value, i};
+            }
+            result.sum += value;
+            result.sum_of_squares += (unsigned __int128)((long long)value * value);
+            if ( wanted & STAT_HISTOGRAM ) {
+                int bin = histogram_bin(request, value);
+                if ( bin >= 0 ) {
+                    result.histogram[bin]++;
+                }
+            }
+            if ( k > 0 ) {
+                if ( heap.size() < k ) {
+                    heap.push(value);
+                }
+                else if ( value > heap.top() ) {
+                    heap.pop();
+                    heap.push(value);
+                }
+            }
+        }
+
+        result.top_k.reserve(heap.size());
+        while ( !heap.empty() ) {
+            result.top_k.push_back(heap.top());
+            heap.pop();
+        }
+        std::reverse(result.top_k.begin(), result.top_k.end());
+        return result;
+    }
+
+    statistics combine(const statistics& left, const statistics& right) const {
+        // left holds lower indices, so it wins ties
+        statistics result;
+        result.minima = right.minima.value < left.minima.value ? right.minima : left.minima;
+        result.maxima = right.maxima.value > left.maxima.value ? right.maxima : left.maxima;
+        result.sum = left.sum + right.sum;
+        result.sum_of_squares = left.sum_of_squares + right.sum_of_squares;
+        result.histogram = left.histogram;
+        for ( size_t bin = 0; bin < right.histogram.size(); bin++ ) {
+            result.histogram[bin] += right.histogram[bin];
+        }
+        // merge two descending lists, keeping the first k
+        result.top_k.resize(left.top_k.size() + right.top_k.size());
+        std::merge(left.top_k.begin(), left.top_k.end(), right.top_k.begin(), right.top_k.end(),
+                   result.top_k.begin(), std::greater<int>());
+        result.top_k.resize(std::min(result.top_k.size(), (size_t)std::max(0, request.k)));
+        return result;
+    }
+};
+
+
+/**
+ * @description: compute the requested statistics of an array in a single parallel pass
+ * @param {int*} array: target array
+ * @param {int} size_of_array: the size of the target array, at least 1
+ * @param {int} num_of_threads: the number of threads
+ * @param {statistics_request} request: which statistics to compute
+ * @return {statistics} the requested statistics
+ */
+statistics get_statistics_fused(int* array, int size_of_array, int num_of_threads, const statistics_request& request) {
+    statistics_op op;
+    op.request = request;
+    return parallel_reduce(array, size_of_array, num_of_threads, op);
+}
+
+
+/**
+ * @description: compute the requested statistics one at a time, each in its own sequential pass
+ * @param {int*} array: target array
+ * @param {int} size_of_array: the size of the target array, at least 1
+ * @param {statistics_request} request: which statistics to compute
+ * @return {statistics} the requested statistics
+ */
+statistics sequential_statistics(int* array, int size_of_array, const statistics_request& request) {
+    statistics result;
+    result.minima = {array[0], 0};
+    result.maxima = {get_maxima_sequential(array, size_of_array), 0};
+    result.sum = 0;
+    result.sum_of_squares = 0;
+
+    for ( int i = 1; i < size_of_array; i++ ) {
+        if ( array[i] < result.minima.value ) {
+            result.minima = {array[i], i};
+        }
+    }
+    while ( array[result.maxima.index] != result.maxima.value ) {
+        result.maxima.index++;
+    }
+    for ( int i = 0; i < size_of_array; i++ ) {
+        result.sum += array[i];
+    }
+    for ( int i = 0; i < size_of_array; i++ ) {
+        result.sum_of_squares += (unsigned __int128)((long long)array[i] * array[i]);
+    }
+    if ( request.statistics & STAT_HISTOGRAM ) {
+        result.histogram.assign(request.num_of_bins, 0);
+        for ( int i = 0; i < size_of_array; i++ ) {
+            int bin = histogram_bin(request, array[i]);
+            if ( bin >= 0 ) {
+                result.histogram[bin]++;
+            }
+        }
+    }
+    if ( request.statistics & STAT_TOP_K ) {
+        std::vector<int> sorted(array, array + size_of_array);
+        std::sort(sorted.begin(), sorted.end(), std::greater<int>());
+        sorted.resize(std::min((size_t)std::max(0, request.k), sorted.size()));
+        result.top_k = sorted;
+    }
+    return result;
+}
+
+/**
+ * @description: compare the requested fields of two statistics results
+ * @return {bool} true if every requested statistic is equal
+ */
+bool same_statistics(const statistics& a, const statistics& b, const statistics_request& request) {
+    const int wanted = request.statistics;
+    return (!(wanted & STAT_MIN) || a.minima.value == b.minima.value)
+        && (!(wanted & STAT_MAX) || a.maxima.value == b.maxima.value)
+        && (!(wanted & STAT_ARGMIN) || a.minima.index == b.minima.index)
+        && (!(wanted & STAT_ARGMAX) || a.maxima.index == b.maxima.index)
+        && (!(wanted & STAT_SUM) || a.sum == b.sum)
+        && (!(wanted & STAT_SUM_OF_SQUARES) || a.sum_of_squares == b.sum_of_squares)
+        && (!(wanted & STAT_HISTOGRAM) || a.histogram == b.histogram)
+        && (!(wanted & STAT_TOP_K) || a.top_k == b.top_k);
+}
+
+/**
+ * @description: decimal representation of an unsigned 128-bit integer
+ */
+std::string to_string_128(unsigned __int128 value) {
+    std::string digits;
+    do {
+        digits.insert(digits.begin(), (char)('0' + (int)(value % 10)));
+        value /= 10;
+    } while ( value > 0 );
+    return digits;
+}
@@ -6,11 +6,15 @@
 #include <iostream>
 #include <chrono>       /* time manipulation */
 #include <string>     
-#include <stdlib.h>     /* random number */
-#include <time.h> 
+#include <stdlib.h>     /* RAND_MAX */
 
 #include "sequential_maxima.cpp"
 #include "parallel_maxima.cpp"
+#include "parallel_reduce.cpp"
+#include "dispatched_maxima.cpp"
+#include "fused_statistics.cpp"
+#include "sliding_window.cpp"
+#include "counter_rng.cpp"
 
 
 int main () {
@@ -33,10 +37,7 @@ int main () {
 
     // initialize array
     int* array = new int[size_of_array];
-    srand(time(NULL));                    // random number generator
-    for ( int i = 0; i < size_of_array; i++ ) {
-        array[i] = rand();
-    }
+    random_fill_integers(array, size_of_array, 0, RAND_MAX, DEFAULT_RANDOM_SEED, (int)std::thread::hardware_concurrency());
     std::cout << "============================================" << std::endl;
 
     // sequential version
@@ -69,6 +70,158 @@ int main () {
     std::cout << "it takes " << duration.count() << " seconds." << std::endl;
     std::cout << "============================================" << std::endl;
 
+    // padded per-thread slots version
+    start_time = std::chrono::steady_clock::now();
+    maxima = get_maxima_reduce(array, size_of_array, num_of_threads);
+    end_time = std::chrono::steady_clock::now();
+    duration = end_time - start_time;
+    std::cout << "padded per-thread slots version: " << std::endl;
+    std::cout << "maxima: " << maxima << std::endl;
+    std::cout << "it takes " << duration.count() << " seconds." << std::endl;
+
+    // minima, argmax and sum against a sequential loop, on a copy whose maxima occurs 4 times,
+    // in different chunks and in different lanes of the vector kernel, so that ties must go to the lowest index
+    int* ties = new int[size_of_array];
+    std::copy(array, array + size_of_array, ties);
+    const int tie_positions[] = {size_of_array - 1, size_of_array / 2 + 3, 37, 9};
+    for ( int position : tie_positions ) {
+        ties[position] = RAND_MAX;
+    }
+    int expected_minima = ties[0];
+    indexed_value expected_argmax = {ties[0], 0};
+    long long expected_sum = 0;
+    for ( int i = 0; i < size_of_array; i++ ) {
+        expected_minima = std::min(expected_minima, ties[i]);
+        if ( ties[i] > expected_argmax.value ) {
+            expected_argmax = {ties[i], i};
+        }
+        expected_sum += ties[i];
+    }
+    bool same_reductions = true;
+    for ( int threads : {1, 2, 3, 7, num_of_threads} ) {
+        const indexed_value argmax = get_argmax_reduce(ties, size_of_array, threads);
+        same_reductions = same_reductions && get_minima_reduce(ties, size_of_array, threads) == expected_minima
+                          && argmax.value == expected_argmax.value && argmax.index == expected_argmax.index
+                          && get_sum_reduce(ties, size_of_array, threads) == expected_sum;
+    }
+    std::cout << "minima: " << expected_minima << ", argmax: " << expected_argmax.value << " at index "
+              << expected_argmax.index << ", sum: " << expected_sum << std::endl;
+    std::cout << "minima, argmax and sum same as a sequential loop for 1 to " << num_of_threads << " threads: "
+              << (same_reductions ? "true" : "false") << std::endl;
+    std::cout << "============================================" << std::endl;
+    delete[] ties;
+
+    // cost model dispatched version
+    CostModel model("cost_model.cache", (int)std::thread::hardware_concurrency());
+    calibrate_maxima(model);
+    model.save();
+    start_time = std::chrono::steady_clock::now();
+    maxima = get_maxima_dispatched(array, size_of_array, model);
+    end_time = std::chrono::steady_clock::now();
+    duration = end_time - start_time;
+    std::cout << "cost model dispatched version: " << std::endl;
+    std::cout << "chosen number of threads: " << model.choose_threads("std::thread", "maxima", size_of_array) << std::endl;
+    std::cout << "maxima: " << maxima << std::endl;
+    std::cout << "it takes " << duration.count() << " seconds." << std::endl;
+    std::cout << "============================================" << std::endl;
+
+    // fused statistics version
+    const statistics_request request = {STAT_ALL, 0, RAND_MAX, 16, 8};
+    start_time = std::chrono::steady_clock::now();
+    statistics fused = get_statistics_fused(array, size_of_array, num_of_threads, request);
+    end_time = std::chrono::steady_clock::now();
+    duration = end_time - start_time;
+    std::cout << "fused statistics version: " << std::endl;
+    std::cout << "maxima: " << fused.maxima.value << " at index " << fused.maxima.index << std::endl;
+    std::cout << "minima: " << fused.minima.value << " at index " << fused.minima.index << std::endl;
+    std::cout << "sum: " << fused.sum << std::endl;
+    std::cout << "sum of squares: " << to_string_128(fused.sum_of_squares) << std::endl;
+    std::cout << "top " << request.k << ":";
+    for ( int value : fused.top_k ) {
+        std::cout << " " << value;
+    }
+    std::cout << std::endl;
+    std::cout << "it takes " << duration.count() << " seconds." << std::endl;
+    start_time = std::chrono::steady_clock::now();
+    statistics separate = sequential_statistics(array, size_of_array, request);
+    end_time = std::chrono::steady_clock::now();
+    duration = end_time - start_time;
+    std::cout << "separate sequential passes take " << duration.count() << " seconds." << std::endl;
+    std::cout << "same as separate sequential passes: " << (same_statistics(fused, separate, request) ? "true" : "false") << std::endl;
+    std::cout << "============================================" << std::endl;
+
+    // sliding window version: the array as a stream, one push at a time and in one batch
+    const int window_size = std::min(64, size_of_array);
+    int* window_maxima = new int[size_of_array];
+    int* window_minima = new int[size_of_array];
+    int* batch_maxima = new int[size_of_array];
+    int* batch_minima = new int[size_of_array];
+    int* naive_maxima = new int[size_of_array];
+    int* naive_minima = new int[size_of_array];
+    sliding_window_extrema window(window_size);
+    start_time = std::chrono::steady_clock::now();
+    for ( int i = 0; i < size_of_array; i++ ) {
+        window.push(array[i]);
+        window_maxima[i] = window.get_maxima();
+        window_minima[i] = window.get_minima();
+    }
+    end_time = std::chrono::steady_clock::now();
+    duration = end_time - start_time;
+    std::cout << "sliding window version (window of " << window_size << "): " << std::endl;
+    std::cout << "maxima of the last window: " << window.get_maxima() << std::endl;
+    std::cout << "minima of the last window: " << window.get_minima() << std::endl;
+    std::cout << "one push at a time takes " << duration.count() << " seconds." << std::endl;
+    sliding_window_extrema batch_window(window_size);
+    start_time = std::chrono::steady_clock::now();
+    batch_window.push_batch(array, size_of_array, batch_maxima, batch_minima);
+    end_time = std::chrono::steady_clock::now();
+    duration = end_time - start_time;
+    std::cout << "one batch takes " << duration.count() << " seconds." << std::endl;
+    naive_window_extrema(array, size_of_array, window_size, naive_maxima, naive_minima);
+    bool same_windows = true;
+    for ( int i = 0; i < size_of_array; i++ ) {
+        same_windows = same_windows && window_maxima[i] == naive_maxima[i] && window_minima[i] == naive_minima[i]
+                       && batch_maxima[i] == naive_maxima[i] && batch_minima[i] == naive_minima[i];
+    }
+    std::cout << "same as scanning every window: " << (same_windows ? "true" : "false") << std::endl;
+
+    // the array as 4 streams of 256 samples, on 3 threads so the ranges of streams are uneven,
+    // pushed in two blocks: one shorter than a window, then the rest
+    const int num_of_streams = 4;
+    const int stream_length = size_of_array / num_of_streams;
+    const int first_block = std::min(stream_length, window_size / 2 + 8);
+    sharded_sliding_windows shards(num_of_streams, window_size);
+    int* block = new int[size_of_array];
+    bool same_shards = true;
+    for ( int s = 0; s < num_of_streams; s++ ) {
+        naive_window_extrema(array + s * stream_length, stream_length, window_size,
+                             naive_maxima + s * stream_length, naive_minima + s * stream_length);
+    }
+    const int blocks[2][2] = {{0, first_block}, {first_block, stream_length}};
+    for ( const auto& range : blocks ) {
+        const int begin = range[0];
+        const int length = range[1] - range[0];
+        for ( int s = 0; s < num_of_streams; s++ ) {
+            std::copy(array + s * stream_length + begin, array + s * stream_length + begin + length, block + s * length);
+        }
+        shards.push_batch(block, length, batch_maxima, batch_minima, 3);
+        for ( int s = 0; s < num_of_streams; s++ ) {
+            for ( int i = 0; i < length; i++ ) {
+                same_shards = same_shards && batch_maxima[s * length + i] == naive_maxima[s * stream_length + begin + i]
+                              && batch_minima[s * length + i] == naive_minima[s * stream_length + begin + i];
+            }
+        }
+    }
+    std::cout << "sharded streams same as scanning every window: " << (same_shards ? "true" : "false") << std::endl;
+    std::cout << "============================================" << std::endl;
+    delete[] block;
+    delete[] window_maxima;
+    delete[] window_minima;
+    delete[] batch_maxima;
+    delete[] batch_minima;
+    delete[] naive_maxima;
+    delete[] naive_minima;
+
     delete[] array;
     return 0;
 }
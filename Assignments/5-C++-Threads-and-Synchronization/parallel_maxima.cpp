@@ -73,8 +73,8 @@ int get_maxima_parallel(int* array, int size_of_array, int num_of_threads, bool
         // return - true if the underlying atomic value was successfully changed, false otherwise.
     };
 
-    // partition
-    int chunk_size = size_of_array / num_of_threads;
+    // partition: round the chunk size up, so that there are never more than num_of_threads chunks
+    int chunk_size = (size_of_array + num_of_threads - 1) / num_of_threads;
     for ( int start_index = 0; start_index < size_of_array; start_index += chunk_size ) {
         if ( method ) {
             threads.emplace_back(std::thread(worker_with_mutex, start_index, chunk_size));
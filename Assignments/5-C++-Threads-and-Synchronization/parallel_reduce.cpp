@@ -0,0 +1,277 @@
+#include <vector>
+#include <thread>
+#include <algorithm>    // std::min, std::max
+#ifdef __AVX2__
+#include <immintrin.h>  // AVX2 intrinsics
+#endif
+
+/*
+    Generic parallel reduction with one cache-line-padded result slot per thread.
+
+    Every thread reduces its own chunk with a (SIMD) leaf kernel and writes the result to its own slot,
+    so threads never share a cache line and never take a lock or retry a compare-and-swap.
+    After the threads are joined, the slots are combined pairwise in a fixed binary tree,
+    so the result does not depend on which thread finishes first.
+
+    An Op is any type with two member functions:
+        R leaf(const T* array, int start, int end) const    reduce array[start, end), start < end
+        R combine(const R& left, const R& right) const      left covers lower indices than right
+*/
+
+const int CACHE_LINE_SIZE = 64;
+
+/**
+ * @description: one per-thread result, aligned and padded to a whole cache line to avoid false sharing
+ */
+template <typename R>
+struct alignas(CACHE_LINE_SIZE) padded_slot {
+    R value;
+};
+
+/**
+ * @description: result of an argmax or argmin reduction
+ */
+struct indexed_value {
+    int value;
+    int index;
+};
+
+
+/**
+ * @description: generic parallel reduction over cache-line-padded per-thread slots
+ * @param {const T*} array: target array
+ * @param {int} size_of_array: the size of the target array, at least 1
+ * @param {int} num_of_threads: the number of threads, clamped to [1, size_of_array]
+ * @param {Op} op: leaf kernel and associative combine function
+ * @return {R} the reduction of the whole array
+ */
+template <typename T, typename Op>
+auto parallel_reduce(const T* array, int size_of_array, int num_of_threads, Op op)
+    -> decltype(op.leaf(array, 0, 1)) {
+
+    using R = decltype(op.leaf(array, 0, 1));
+
+    num_of_threads = std::max(1, std::min(num_of_threads, size_of_array));
+    std::vector<padded_slot<R>> slots(num_of_threads);
+
+    // partition: thread t gets [size * t / n, size * (t + 1) / n), so exactly n non-empty chunks
+    auto worker = [array, size_of_array, num_of_threads, &slots, &op](int thread_id) -> void {
+        int start_index = (int)((long long)size_of_array * thread_id / num_of_threads);
+        int end_index = (int)((long long)size_of_array * (thread_id + 1) / num_of_threads);
+        slots[thread_id].value = op.leaf(array, start_index, end_index);
+    };
+
+    std::vector<std::thread> threads;
+    for ( int thread_id = 1; thread_id < num_of_threads; thread_id++ ) {
+        threads.emplace_back(worker, thread_id);
+    }
+    worker(0);
+    for ( std::thread& thread : threads ) {
+        thread.join();
+    }
+
+    // tree combine: at each level, slot i absorbs its right neighbour at distance stride
+    for ( int stride = 1; stride < num_of_threads; stride *= 2 ) {
+        for ( int i = 0; i + stride < num_of_threads; i += 2 * stride ) {
+            slots[i].value = op.combine(slots[i].value, slots[i + stride].value);
+        }
+    }
+
+    return slots[0].value;
+}
+
+
+/**
+ * @description: maximum of an int array
+ */
+struct max_op {
+    int leaf(const int* array, int start, int end) const {
+        int maxima = array[start];
+        int i = start;
+#ifdef __AVX2__
+        if ( end - start >= 8 ) {
+            __m256i lanes = _mm256_loadu_si256((const __m256i*)(array + start));
+            for ( i = start + 8; i + 8 <= end; i += 8 ) {
+                lanes = _mm256_max_epi32(lanes, _mm256_loadu_si256((const __m256i*)(array + i)));
+            }
+            alignas(32) int lane_values[8];
+            _mm256_store_si256((__m256i*)lane_values, lanes);
+            for ( int lane = 0; lane < 8; lane++ ) {
+                maxima = std::max(maxima, lane_values[lane]);
+            }
+        }
+#endif
+        for ( ; i < end; i++ ) {
+            maxima = std::max(maxima, array[i]);
+        }
+        return maxima;
+    }
+    int combine(int left, int right) const {
+        return std::max(left, right);
+    }
+};
+
+/**
+ * @description: minimum of an int array
+ */
+struct min_op {
+    int leaf(const int* array, int start, int end) const {
+        int minima = array[start];
+        int i = start;
+#ifdef __AVX2__
+        if ( end - start >= 8 ) {
+            __m256i lanes = _mm256_loadu_si256((const __m256i*)(array + start));
+            for ( i = start + 8; i + 8 <= end; i += 8 ) {
+                lanes = _mm256_min_epi32(lanes, _mm256_loadu_si256((const __m256i*)(array + i)));
+            }
+            alignas(32) int lane_values[8];
+            _mm256_store_si256((__m256i*)lane_values, lanes);
+            for ( int lane = 0; lane < 8; lane++ ) {
+                minima = std::min(minima, lane_values[lane]);
+            }
+        }
+#endif
+        for ( ; i < end; i++ ) {
+            minima = std::min(minima, array[i]);
+        }
+        return minima;
+    }
+    int combine(int left, int right) const {
+        return std::min(left, right);
+    }
+};
+
+/**
+ * @description: sum of an int array, accumulated in 64 bits so it cannot overflow
+ */
+struct sum_op {
+    long long leaf(const int* array, int start, int end) const {
+        long long sum = 0;
+        int i = start;
+#ifdef __AVX2__
+        __m256i low_lanes = _mm256_setzero_si256();
+        __m256i high_lanes = _mm256_setzero_si256();
+        for ( ; i + 8 <= end; i += 8 ) {
+            __m256i values = _mm256_loadu_si256((const __m256i*)(array + i));
+            low_lanes = _mm256_add_epi64(low_lanes, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(values)));
+            high_lanes = _mm256_add_epi64(high_lanes, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(values, 1)));
+        }
+        alignas(32) long long lane_values[4];
+        _mm256_store_si256((__m256i*)lane_values, _mm256_add_epi64(low_lanes, high_lanes));
+        sum = lane_values[0] + lane_values[1] + lane_values[2] + lane_values[3];
+#endif
+        for ( ; i < end; i++ ) {
+            sum += array[i];
+        }
+        return sum;
+    }
+    long long combine(long long left, long long right) const {
+        return left + right;
+    }
+};
+
+/**
+ * @description: maximum of an int array and the lowest index at which it occurs
+ */
+struct argmax_op {
+    indexed_value leaf(const int* array, int start, int end) const {
+        indexed_value best = {array[start], start};
+        int i = start;
+#ifdef __AVX2__
+        if ( end - start >= 8 ) {
+            // lane k tracks the maximum of the elements i with i % 8 == k and its first index;
+            // a strictly-greater comparison keeps the earliest index on ties
+            const __m256i step = _mm256_set1_epi32(8);
+            __m256i indices = _mm256_add_epi32(_mm256_set1_epi32(start), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+            __m256i best_values = _mm256_loadu_si256((const __m256i*)(array + start));
+            __m256i best_indices = indices;
+            for ( i = start + 8; i + 8 <= end; i += 8 ) {
+                indices = _mm256_add_epi32(indices, step);
+                __m256i values = _mm256_loadu_si256((const __m256i*)(array + i));
+                __m256i greater = _mm256_cmpgt_epi32(values, best_values);
+                best_values = _mm256_blendv_epi8(best_values, values, greater);
+                best_indices = _mm256_blendv_epi8(best_indices, indices, greater);
+            }
+            alignas(32) int lane_values[8];
+            alignas(32) int lane_indices[8];
+            _mm256_store_si256((__m256i*)lane_values, best_values);
+            _mm256_store_si256((__m256i*)lane_indices, best_indices);
+            for ( int lane = 0; lane < 8; lane++ ) {
+                if ( lane_values[lane] > best.value
+                    || (lane_values[lane] == best.value && lane_indices[lane] < best.index) ) {
+                    best.value = lane_values[lane];
+                    best.index = lane_indices[lane];
+                }
+            }
+        }
+#endif
+        for ( ; i < end; i++ ) {
+            if ( array[i] > best.value ) {
+                best.value = array[i];
+                best.index = i;
+            }
+        }
+        return best;
+    }
+    indexed_value combine(const indexed_value& left, const indexed_value& right) const {
+        // left holds lower indices, so it wins ties
+        return right.value > left.value ? right : left;
+    }
+};
+
+
+/**
+ * @description: parallel maxima over padded per-thread slots
+ * @param {int*} array: target array
+ * @param {int} size_of_array: the size of the target array
+ * @param {int} num_of_threads: the number of threads
+ * @return {int} the global maxima of the target array, -1 if the array is empty
+ */
+int get_maxima_reduce(int* array, int size_of_array, int num_of_threads) {
+    if ( size_of_array <= 0 ) {
+        return -1;
+    }
+    return parallel_reduce(array, size_of_array, num_of_threads, max_op());
+}
+
+/**
+ * @description: parallel minima over padded per-thread slots
+ * @param {int*} array: target array
+ * @param {int} size_of_array: the size of the target array
+ * @param {int} num_of_threads: the number of threads
+ * @return {int} the global minima of the target array, -1 if the array is empty
+ */
+int get_minima_reduce(int* array, int size_of_array, int num_of_threads) {
+    if ( size_of_array <= 0 ) {
+        return -1;
+    }
+    return parallel_reduce(array, size_of_array, num_of_threads, min_op());
+}
+
+/**
+ * @description: parallel argmax over padded per-thread slots
+ * @param {int*} array: target array
+ * @param {int} size_of_array: the size of the target array
+ * @param {int} num_of_threads: the number of threads
+ * @return {indexed_value} the global maxima and the lowest index holding it, {-1, -1} if the array is empty
+ */
+indexed_value get_argmax_reduce(int* array, int size_of_array, int num_of_threads) {
+    if ( size_of_array <= 0 ) {
+        return {-1, -1};
+    }
+    return parallel_reduce(array, size_of_array, num_of_threads, argmax_op());
+}
+
+/**
+ * @description: parallel sum over padded per-thread slots
+ * @param {int*} array: target array
+ * @param {int} size_of_array: the size of the target array
+ * @param {int} num_of_threads: the number of threads
+ * @return {long long} the sum of the target array, 0 if the array is empty
+ */
+long long get_sum_reduce(int* array, int size_of_array, int num_of_threads) {
+    if ( size_of_array <= 0 ) {
+        return 0;
+    }
+    return parallel_reduce(array, size_of_array, num_of_threads, sum_op());
+}
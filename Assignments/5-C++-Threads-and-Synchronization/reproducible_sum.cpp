@@ -0,0 +1,260 @@
+#include <vector>
+#include <thread>
+#include <algorithm>    // std::min, std::max
+#include <cmath>        // std::abs, std::frexp, std::ldexp, std::fma, std::isinf, std::isfinite
+
+/*
+    Bitwise-reproducible sums and dot products of float and double arrays.
+
+    Floating point addition is not associative, so a parallel or vectorized sum usually changes in its last
+    bits with the number of threads or the vector width. Here every term is pre-rounded: it is cut into
+    REPRODUCIBLE_FOLDS pieces on a fixed grid of powers of two, and each piece is added into its own
+    accumulator without any rounding error. Exact sums do not depend on the order of the terms, so the
+    result is the same, to the bit, for any number of threads, any vector width and any schedule.
+
+    The algorithm makes two passes:
+        1. m = max |x_i|, which does not depend on the order either, and the terms are scaled by a power of
+           two e so that m < 1 (an exact scaling). For a subnormal m, 2^-e is above the largest double, so
+           the terms are scaled by two finite powers of two in turn.
+        2. For sigma_1 = 2^L, with 2^L >= 2n, and sigma_{k+1} = sigma_k * 2^(L - 53), every term v is split as
+               q_k = (sigma_k + v) - sigma_k,    v = v - q_k
+           q_k is v rounded to a multiple of 2^-53 sigma_k, and the rest of v goes to the next fold. Every
+           partial sum of the q_k is such a multiple, and at most sigma_k / 2 in magnitude, so it is exact.
+    The result is ((S_1 + S_2) + S_3) * 2^e. The terms left after the last fold are dropped, an error of at
+    most n * 2^-53 * sigma_3 * 2^e; for n = 2^26 terms that is about 2^-51 max |x_i|.
+
+    A float dot product uses the exact double product of each pair. A double dot product splits every product
+    into x * y = p + r with an fma, and sums the 2n terms p and r; a product that overflows has r = 0, so that
+    p = inf reaches the fallback instead of inf - inf. Arrays with a NaN or an infinity fall back to a sequential
+    sum in index order, which is also reproducible. So do sums of more than 2^39 terms, since every fold must
+    shift by at least 13 bits. The pieces rely on IEEE rounding, so do not compile with -ffast-math.
+*/
+
+const int REPRODUCIBLE_FOLDS{3};
+const int REPRODUCIBLE_LANES{16};      // 8 lanes make GCC vectorize across blocks instead, with shuffles
+const long long REPRODUCIBLE_MAX_TERMS{1LL << 39};
+
+/**
+ * @description: run f(t, first, last) for t in [0, num_of_threads), on contiguous ranges of [0, n)
+ */
+template <typename F>
+void reproducible_thread_ranges(long long n, int num_of_threads, const F& f) {
+    std::vector<std::thread> threads;
+    for ( int t = 1; t < num_of_threads; t++ ) {
+        threads.push_back(std::thread(f, t, n * t / num_of_threads, n * (t + 1) / num_of_threads));
+    }
+    f(0, 0LL, n / num_of_threads);
+    for ( std::thread& thread : threads ) {
+        thread.join();
+    }
+}
+
+/**
+ * @description: the sum of the terms of n elements, sequentially in index order
+ */
+template <typename Terms>
+double sequential_sum_of_terms(long long n, const Terms& terms) {
+    const int P = Terms::parts;
+    double sum = 0;
+    for ( long long i = 0; i < n; i++ ) {
+        double parts[P];
+        terms(i, parts);
+        for ( int p = 0; p < P; p++ ) {
+            sum += parts[p];
+        }
+    }
+    return sum;
+}
+
+/**
+ * @description: the reproducible sum of the terms of n elements
+ * @param {Terms} terms: terms(i, parts) writes the Terms::parts terms of element i into parts
+ * @param {int} num_of_threads: the number of threads
+ * @return {double} the sum, the same for any number of threads
+ */
+template <typename Terms>
+double reproducible_sum_of_terms(long long n, int num_of_threads, const Terms& terms) {
+    const int P = Terms::parts;
+    num_of_threads = (int)std::max(1LL, std::min((long long)num_of_threads, n));
+    if ( n <= 0 ) {
+        return 0;
+    }
+    if ( n > REPRODUCIBLE_MAX_TERMS / P ) {
+        return sequential_sum_of_terms(n, terms);
+    }
+
+    // pass 1: the largest magnitude, and whether any term is NaN
+    std::vector<double> maxima(num_of_threads, 0);
+    std::vector<long long> nans(num_of_threads, 0);
+    reproducible_thread_ranges(n, num_of_threads, [&terms, &maxima, &nans](int t, long long first, long long last) {
+        double lanes[REPRODUCIBLE_LANES] = {0};
+        long long lane_nans[REPRODUCIBLE_LANES] = {0};
+        long long i = first;
+        for ( ; i + REPRODUCIBLE_LANES <= last; i += REPRODUCIBLE_LANES ) {
+            for ( int lane = 0; lane < REPRODUCIBLE_LANES; lane++ ) {
+                double parts[P];
+                terms(i + lane, parts);
+                for ( int p = 0; p < P; p++ ) {
+                    const double magnitude = std::abs(parts[p]);
+                    lanes[lane] = magnitude > lanes[lane] ? magnitude : lanes[lane];
+                    lane_nans[lane] += magnitude != magnitude;
+                }
+            }
+        }
+        for ( ; i < last; i++ ) {
+            double parts[P];
+            terms(i, parts);
+            for ( int p = 0; p < P; p++ ) {
+                const double magnitude = std::abs(parts[p]);
+                lanes[0] = magnitude > lanes[0] ? magnitude : lanes[0];
+                lane_nans[0] += magnitude != magnitude;
+            }
+        }
+        maxima[t] = *std::max_element(lanes, lanes + REPRODUCIBLE_LANES);
+        nans[t] = 0;
+        for ( long long count : lane_nans ) {
+            nans[t] += count;
+        }
+    });
+    const double maximum = *std::max_element(maxima.begin(), maxima.end());
+    long long nan_count = 0;
+    for ( long long count : nans ) {
+        nan_count += count;
+    }
+    if ( maximum == 0 ) {
+        return 0;
+    }
+    if ( nan_count > 0 || std::isinf(maximum) ) {
+        return sequential_sum_of_terms(n, terms);
+    }
+
+    // the grid: maximum * scale < 1, sigma_1 >= 2 * (number of terms)
+    int exponent;
+    std::frexp(maximum, &exponent);
+    // for a subnormal maximum, 2^-exponent overflows; split it into two powers of two that do not
+    const int low_shift = exponent < -1000 ? -exponent / 2 : 0;
+    const double scale = std::ldexp(1.0, -exponent - low_shift);
+    const double low_scale = std::ldexp(1.0, low_shift);
+    int L = 1;
+    while ( (1LL << (L - 1)) < n * P ) {
+        L++;
+    }
+    double sigma[REPRODUCIBLE_FOLDS];
+    sigma[0] = std::ldexp(1.0, L);
+    for ( int k = 1; k < REPRODUCIBLE_FOLDS; k++ ) {
+        sigma[k] = std::ldexp(sigma[k - 1], L - 53);
+    }
+
+    // pass 2: exact sums of the pieces, per lane and per thread
+    std::vector<double> fold_sums((size_t)num_of_threads * REPRODUCIBLE_FOLDS, 0);
+    reproducible_thread_ranges(n, num_of_threads, [&terms, &fold_sums, sigma, scale, low_scale](int t, long long first, long long last) {
+        double folds[REPRODUCIBLE_FOLDS][REPRODUCIBLE_LANES] = {{0}};
+        long long i = first;
+        for ( ; i + REPRODUCIBLE_LANES <= last; i += REPRODUCIBLE_LANES ) {
+            for ( int lane = 0; lane < REPRODUCIBLE_LANES; lane++ ) {
+                double parts[P];
+                terms(i + lane, parts);
+                for ( int p = 0; p < P; p++ ) {
+                    double v = parts[p] * scale * low_scale;
+                    for ( int k = 0; k < REPRODUCIBLE_FOLDS; k++ ) {
+                        const double q = (sigma[k] + v) - sigma[k];
+                        folds[k][lane] += q;
+                        v -= q;
+                    }
+                }
+            }
+        }
+        for ( ; i < last; i++ ) {
+            double parts[P];
+            terms(i, parts);
+            for ( int p = 0; p < P; p++ ) {
+                double v = parts[p] * scale * low_scale;
+                for ( int k = 0; k < REPRODUCIBLE_FOLDS; k++ ) {
+                    const double q = (sigma[k] + v) - sigma[k];
+                    folds[k][0] += q;
+                    v -= q;
+                }
+            }
+        }
+        for ( int k = 0; k < REPRODUCIBLE_FOLDS; k++ ) {
+            double sum = 0;
+            for ( int lane = 0; lane < REPRODUCIBLE_LANES; lane++ ) {
+                sum += folds[k][lane];
+            }
+            fold_sums[(size_t)t * REPRODUCIBLE_FOLDS + k] = sum;
+        }
+    });
+
+    // every fold sum is exact, only the last additions round
+    double result = 0;
+    for ( int k = 0; k < REPRODUCIBLE_FOLDS; k++ ) {
+        double fold = 0;
+        for ( int t = 0; t < num_of_threads; t++ ) {
+            fold += fold_sums[(size_t)t * REPRODUCIBLE_FOLDS + k];
+        }
+        result += fold;
+    }
+    return std::ldexp(result, exponent);
+}
+
+/**
+ * @description: the terms x[i] of a sum
+ */
+template <typename T>
+struct sum_terms {
+    static constexpr int parts = 1;
+    const T* x;
+    void operator()(long long i, double* out) const { out[0] = x[i]; }
+};
+
+/**
+ * @description: the terms x[i] * y[i] of a float dot product, exact in double
+ */
+struct float_dot_terms {
+    static constexpr int parts = 1;
+    const float* x;
+    const float* y;
+    void operator()(long long i, double* out) const { out[0] = (double)x[i] * y[i]; }
+};
+
+/**
+ * @description: the terms p + r = x[i] * y[i] of a double dot product, p the rounded product and r its error,
+ *               r = 0 if p is not finite
+ */
+struct double_dot_terms {
+    static constexpr int parts = 2;
+    const double* x;
+    const double* y;
+    void operator()(long long i, double* out) const {
+        out[0] = x[i] * y[i];
+        out[1] = std::isfinite(out[0]) ? std::fma(x[i], y[i], -out[0]) : 0;
+    }
+};
+
+/**
+ * @description: sum of an array, bitwise identical for any number of threads
+ * @param {const float*} x: the array
+ * @param {long long} n: the length of the array
+ * @param {int} num_of_threads: the number of threads
+ */
+double reproducible_sum(const float* x, long long n, int num_of_threads) {
+    return reproducible_sum_of_terms(n, num_of_threads, sum_terms<float>{x});
+}
+
+double reproducible_sum(const double* x, long long n, int num_of_threads) {
+    return reproducible_sum_of_terms(n, num_of_threads, sum_terms<double>{x});
+}
+
+/**
+ * @description: dot product of two arrays, bitwise identical for any number of threads
+ * @param {const float*} x, y: the arrays
+ * @param {long long} n: the length of the arrays
+ * @param {int} num_of_threads: the number of threads
+ */
+double reproducible_dot(const float* x, const float* y, long long n, int num_of_threads) {
+    return reproducible_sum_of_terms(n, num_of_threads, float_dot_terms{x, y});
+}
+
+double reproducible_dot(const double* x, const double* y, long long n, int num_of_threads) {
+    return reproducible_sum_of_terms(n, num_of_threads, double_dot_terms{x, y});
+}
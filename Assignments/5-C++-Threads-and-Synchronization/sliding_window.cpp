@@ -0,0 +1,319 @@
+#include <vector>
+#include <thread>
+#include <climits>      // INT_MIN, INT_MAX
+#include <algorithm>    // std::min, std::max
+#ifdef __AVX2__
+#include <immintrin.h>  // AVX2 intrinsics
+#endif
+
+/*
+    Rolling maxima and minima over the last W samples of an unbounded stream.
+
+    push() keeps two monotonic deques, decreasing for the maxima and increasing for the minima, stored in
+    preallocated ring buffers of W entries each, so that a push is amortized O(1), a query is O(1),
+    and push() never allocates.
+
+    push_batch() handles a block of at least W samples with the van Herk / Gil-Werman algorithm instead:
+    the block, preceded by the last W - 1 samples, is cut into segments of W samples; a forward running
+    maximum within each segment and a backward running maximum within each segment are computed, and the
+    window maximum ending at i is max(backward[i - W + 1], forward[i]), an elementwise max done with AVX2.
+    Afterwards the deques are rebuilt from the last W samples, so push() and push_batch() can be mixed.
+*/
+
+/**
+ * @description: elementwise out[i] = max(a[i], b[i]) or min(a[i], b[i]) for i in [0, n)
+ */
+inline void elementwise_extrema(const int* a, const int* b, int* out, int n, bool maxima) {
+    int i = 0;
+#ifdef __AVX2__
+    for ( ; i + 8 <= n; i += 8 ) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i y = _mm256_loadu_si256((const __m256i*)(b + i));
+        __m256i z = maxima ? _mm256_max_epi32(x, y) : _mm256_min_epi32(x, y);
+        _mm256_storeu_si256((__m256i*)(out + i), z);
+    }
+#endif
+    for ( ; i < n; i++ ) {
+        out[i] = maxima ? std::max(a[i], b[i]) : std::min(a[i], b[i]);
+    }
+}
+
+
+class alignas(64) sliding_window_extrema {
+
+public:
+
+    /**
+     * @description: constructor
+     * @param {int} window_size: W, the number of most recent samples the extrema are taken over, at least 1
+     */
+    explicit sliding_window_extrema(int window_size) :
+        window_size(std::max(1, window_size)),
+        samples(this->window_size),
+        max_values(this->window_size), max_indices(this->window_size),
+        min_values(this->window_size), min_indices(this->window_size) {
+        clear();
+    }
+
+    /**
+     * @description: forget every sample
+     */
+    void clear() {
+        count = 0;
+        max_head = max_size = 0;
+        min_head = min_size = 0;
+    }
+
+    /**
+     * @description: append one sample to the stream, amortized O(1)
+     * @param {int} value: the sample
+     */
+    void push(int value) {
+        const long long index = count++;
+        samples[index % window_size] = value;
+        const long long oldest = index - window_size + 1;
+
+        // each deque first drops its front if it left the window, which leaves at most W - 1 entries,
+        // and then appends the new sample
+
+        // maxima deque: values strictly decreasing from front to back
+        if ( max_size > 0 && max_indices[max_head] < oldest ) {
+            max_head = slot(max_head, 1);
+            max_size--;
+        }
+        while ( max_size > 0 && max_values[slot(max_head, max_size - 1)] <= value ) {
+            max_size--;
+        }
+        max_values[slot(max_head, max_size)] = value;
+        max_indices[slot(max_head, max_size)] = index;
+        max_size++;
+
+        // minima deque: values strictly increasing from front to back
+        if ( min_size > 0 && min_indices[min_head] < oldest ) {
+            min_head = slot(min_head, 1);
+            min_size--;
+        }
+        while ( min_size > 0 && min_values[slot(min_head, min_size - 1)] >= value ) {
+            min_size--;
+        }
+        min_values[slot(min_head, min_size)] = value;
+        min_indices[slot(min_head, min_size)] = index;
+        min_size++;
+    }
+
+    /**
+     * @description: the maxima of the last W samples, INT_MIN before the first sample
+     */
+    int get_maxima() const {
+        return max_size > 0 ? max_values[max_head] : INT_MIN;
+    }
+
+    /**
+     * @description: the minima of the last W samples, INT_MAX before the first sample
+     */
+    int get_minima() const {
+        return min_size > 0 ? min_values[min_head] : INT_MAX;
+    }
+
+    /**
+     * @description: the number of samples pushed so far
+     */
+    long long size() const {
+        return count;
+    }
+
+    /**
+     * @description: append a block of samples, reporting the window extrema after each one
+     * @param {const int*} values: the samples
+     * @param {int} n: the number of samples
+     * @param {int*} out_maxima: if not null, receives get_maxima() after each of the n pushes
+     * @param {int*} out_minima: if not null, receives get_minima() after each of the n pushes
+     */
+    void push_batch(const int* values, int n, int* out_maxima, int* out_minima) {
+        if ( n < window_size ) {
+            for ( int i = 0; i < n; i++ ) {
+                push(values[i]);
+                if ( out_maxima ) {
+                    out_maxima[i] = get_maxima();
+                }
+                if ( out_minima ) {
+                    out_minima[i] = get_minima();
+                }
+            }
+            return;
+        }
+
+        // extended = the last W - 1 samples (padded with a neutral value while the stream is shorter) + values
+        const int history = window_size - 1;
+        const int length = history + n;
+        extended.resize(length);
+        forward.resize(length);
+        backward.resize(length);
+        for ( int pass = 0; pass < 2; pass++ ) {
+            const bool maxima = pass == 0;
+            int* out = maxima ? out_maxima : out_minima;
+            if ( out == nullptr ) {
+                continue;
+            }
+            const int neutral = maxima ? INT_MIN : INT_MAX;
+            for ( int i = 0; i < history; i++ ) {
+                long long index = count - history + i;
+                extended[i] = index >= 0 ? samples[index % window_size] : neutral;
+            }
+            std::copy(values, values + n, extended.begin() + history);
+            sliding_extrema(extended.data(), length, out, maxima);
+        }
+
+        // record the samples and rebuild the deques from the last W of them
+        for ( int i = std::max(0, n - window_size); i < n; i++ ) {
+            samples[(count + i) % window_size] = values[i];
+        }
+        count += n;
+        max_head = max_size = 0;
+        min_head = min_size = 0;
+        const long long first = count - window_size;
+        for ( long long index = first; index < count; index++ ) {
+            const int value = samples[index % window_size];
+            while ( max_size > 0 && max_values[max_size - 1] <= value ) {
+                max_size--;
+            }
+            max_values[max_size] = value;
+            max_indices[max_size] = index;
+            max_size++;
+            while ( min_size > 0 && min_values[min_size - 1] >= value ) {
+                min_size--;
+            }
+            min_values[min_size] = value;
+            min_indices[min_size] = index;
+            min_size++;
+        }
+    }
+
+private:
+
+    /**
+     * @description: ring buffer position offset places after head
+     */
+    int slot(int head, int offset) const {
+        int position = head + offset;
+        return position >= window_size ? position - window_size : position;
+    }
+
+    /**
+     * @description: van Herk / Gil-Werman sliding extrema; out[i] = extrema of data[i, i + W) for i in [0, length - W]
+     */
+    void sliding_extrema(const int* data, int length, int* out, bool maxima) {
+        for ( int segment = 0; segment < length; segment += window_size ) {
+            const int end = std::min(segment + window_size, length);
+            forward[segment] = data[segment];
+            for ( int i = segment + 1; i < end; i++ ) {
+                forward[i] = maxima ? std::max(forward[i - 1], data[i]) : std::min(forward[i - 1], data[i]);
+            }
+            backward[end - 1] = data[end - 1];
+            for ( int i = end - 2; i >= segment; i-- ) {
+                backward[i] = maxima ? std::max(backward[i + 1], data[i]) : std::min(backward[i + 1], data[i]);
+            }
+        }
+        // the window [i, i + W) spans the end of one segment and the start of the next (or is one segment)
+        elementwise_extrema(backward.data(), forward.data() + window_size - 1, out, length - window_size + 1, maxima);
+    }
+
+    const int window_size;
+    long long count;
+    std::vector<int> samples;           // ring buffer of the last W samples
+    std::vector<int> max_values;        // ring buffers of the two monotonic deques
+    std::vector<long long> max_indices;
+    int max_head;
+    int max_size;
+    std::vector<int> min_values;
+    std::vector<long long> min_indices;
+    int min_head;
+    int min_size;
+    std::vector<int> extended;          // scratch space of push_batch, grown on demand and reused
+    std::vector<int> forward;
+    std::vector<int> backward;
+};
+
+
+/**
+ * @description: many independent streams with the same window size, sharded across threads
+ */
+class sharded_sliding_windows {
+
+public:
+
+    /**
+     * @description: constructor
+     * @param {int} num_of_streams: the number of independent streams
+     * @param {int} window_size: W for every stream
+     */
+    sharded_sliding_windows(int num_of_streams, int window_size) :
+        streams(num_of_streams, sliding_window_extrema(window_size)) {
+    }
+
+    /**
+     * @description: push a block of n samples to every stream; stream s owns row s of the row-major inputs and outputs
+     * @param {const int*} values: num_of_streams * n samples
+     * @param {int} n: the number of samples per stream
+     * @param {int*} out_maxima: num_of_streams * n window maxima, or null
+     * @param {int*} out_minima: num_of_streams * n window minima, or null
+     * @param {int} num_of_threads: the number of threads; each thread owns a contiguous range of streams
+     */
+    void push_batch(const int* values, int n, int* out_maxima, int* out_minima, int num_of_threads) {
+        const int num_of_streams = (int)streams.size();
+        num_of_threads = std::max(1, std::min(num_of_threads, num_of_streams));
+
+        auto worker = [&](int thread_id) -> void {
+            int first = (int)((long long)num_of_streams * thread_id / num_of_threads);
+            int last = (int)((long long)num_of_streams * (thread_id + 1) / num_of_threads);
+            for ( int s = first; s < last; s++ ) {
+                long long offset = (long long)s * n;
+                streams[s].push_batch(values + offset, n,
+                                      out_maxima ? out_maxima + offset : nullptr,
+                                      out_minima ? out_minima + offset : nullptr);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for ( int thread_id = 1; thread_id < num_of_threads; thread_id++ ) {
+            threads.emplace_back(worker, thread_id);
+        }
+        worker(0);
+        for ( std::thread& thread : threads ) {
+            thread.join();
+        }
+    }
+
+    /**
+     * @description: the stream with the given index
+     */
+    sliding_window_extrema& stream(int index) {
+        return streams[index];
+    }
+
+private:
+
+    std::vector<sliding_window_extrema> streams;
+};
+
+
+/**
+ * @description: reference extrema by scanning every window, O(n * W); out[i] covers values[max(0, i - W + 1), i]
+ * @param {const int*} values: the samples of one stream
+ * @param {int} n: the number of samples
+ * @param {int} window_size: W
+ * @param {int*} out_maxima: receives n window maxima
+ * @param {int*} out_minima: receives n window minima
+ */
+void naive_window_extrema(const int* values, int n, int window_size, int* out_maxima, int* out_minima) {
+    for ( int i = 0; i < n; i++ ) {
+        int maxima = values[i];
+        int minima = values[i];
+        for ( int j = std::max(0, i - window_size + 1); j < i; j++ ) {
+            maxima = std::max(maxima, values[j]);
+            minima = std::min(minima, values[j]);
+        }
+        out_maxima[i] = maxima;
+        out_minima[i] = minima;
+    }
+}
@@ -0,0 +1,423 @@
+/*
+ * @Description: scalability benchmark of synchronization primitives on the shared maxima workload
+ *
+ * Every thread performs the same operation over and over: offer a new value to a shared maxima.
+ * The values keep increasing, so most offers are real updates, which is the worst case for contention.
+ * The benchmark sweeps 1, 2, 4, ..., N threads, with and without pinning each thread to a core,
+ * and reports throughput and sampled p50/p99 latency per operation for:
+ *   - mutex:          std::mutex around a plain int (get_maxima_parallel with method = true)
+ *   - spinlock:       test-and-test-and-set lock
+ *   - ticket lock:    FIFO lock with a next-ticket and a now-serving counter
+ *   - MCS lock:       queue lock, each waiter spins on its own node
+ *   - CAS loop:       compare_exchange_weak loop (get_maxima_parallel with method = false)
+ *   - fetch_max:      load first and only CAS when the offer is larger, the usual emulation of fetch_max
+ *   - sharded:        one atomic maxima per shard, threads spread over num_of_threads / 4 shards
+ *   - slots packed:   one relaxed atomic int per thread, adjacent in memory (false sharing)
+ *   - slots padded:   one relaxed atomic int per thread, each on its own cache line
+ *
+ * Compile and run:
+ *   $ g++ -O2 -pthread -o synchronization_benchmark.exe synchronization_benchmark.cpp
+ *   $ ./synchronization_benchmark.exe [operations per thread] [maximum number of threads]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>       /* time manipulation */
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>       // atomic data types
+#include <algorithm>    // std::sort, std::max
+#include <functional>
+#include <pthread.h>    // pthread_setaffinity_np
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>  // _mm_pause
+#endif
+
+const int CACHE_LINE_SIZE = 64;
+
+/**
+ * @description: one operation in every LATENCY_SAMPLE_PERIOD is timed on its own
+ */
+const int LATENCY_SAMPLE_PERIOD = 64;
+
+/**
+ * @description: spin-wait hint; after SPINS_BEFORE_YIELD spins, give the core away so that
+ *               oversubscribed runs (more threads than cores) still make progress
+ */
+const int SPINS_BEFORE_YIELD = 1024;
+
+inline void cpu_relax(int& spins) {
+    if ( ++spins >= SPINS_BEFORE_YIELD ) {
+        spins = 0;
+        std::this_thread::yield();
+        return;
+    }
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#endif
+}
+
+
+/**
+ * @description: test-and-test-and-set spinlock
+ */
+class spin_lock {
+public:
+    void lock() {
+        int spins = 0;
+        while ( flag.exchange(true, std::memory_order_acquire) ) {
+            while ( flag.load(std::memory_order_relaxed) ) {
+                cpu_relax(spins);
+            }
+        }
+    }
+    void unlock() {
+        flag.store(false, std::memory_order_release);
+    }
+private:
+    std::atomic<bool> flag{false};
+};
+
+/**
+ * @description: ticket lock, grants the lock in arrival order
+ */
+class ticket_lock {
+public:
+    void lock() {
+        const unsigned ticket = next_ticket.fetch_add(1, std::memory_order_relaxed);
+        int spins = 0;
+        while ( now_serving.load(std::memory_order_acquire) != ticket ) {
+            cpu_relax(spins);
+        }
+    }
+    void unlock() {
+        now_serving.store(now_serving.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+private:
+    alignas(CACHE_LINE_SIZE) std::atomic<unsigned> next_ticket{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<unsigned> now_serving{0};
+};
+
+/**
+ * @description: MCS queue lock; every waiter spins on the flag in its own node
+ */
+class mcs_lock {
+public:
+    struct alignas(CACHE_LINE_SIZE) node {
+        std::atomic<node*> next{nullptr};
+        std::atomic<bool> locked{false};
+    };
+    void lock(node& me) {
+        me.next.store(nullptr, std::memory_order_relaxed);
+        me.locked.store(true, std::memory_order_relaxed);
+        node* previous = tail.exchange(&me, std::memory_order_acq_rel);
+        if ( previous != nullptr ) {
+            previous->next.store(&me, std::memory_order_release);
+            int spins = 0;
+            while ( me.locked.load(std::memory_order_acquire) ) {
+                cpu_relax(spins);
+            }
+        }
+    }
+    void unlock(node& me) {
+        node* successor = me.next.load(std::memory_order_acquire);
+        if ( successor == nullptr ) {
+            node* expected = &me;
+            if ( tail.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel) ) {
+                return;
+            }
+            int spins = 0;
+            while ( (successor = me.next.load(std::memory_order_acquire)) == nullptr ) {
+                cpu_relax(spins);
+            }
+        }
+        successor->locked.store(false, std::memory_order_release);
+    }
+private:
+    std::atomic<node*> tail{nullptr};
+};
+
+template <typename T>
+struct alignas(CACHE_LINE_SIZE) padded {
+    T value;
+};
+
+
+/**
+ * @description: result of one benchmark run
+ */
+struct run_result {
+    double operations_per_second;
+    double p50_nanoseconds;
+    double p99_nanoseconds;
+    bool correct;
+};
+
+/**
+ * @description: pin the calling thread to one CPU
+ * @return {bool} true if the affinity was set
+ */
+bool pin_to_cpu(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu % std::max(1u, std::thread::hardware_concurrency()), &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+/**
+ * @description: run update(thread_id, value) operations_per_thread times on each of num_of_threads threads
+ * @param {int} num_of_threads: the number of threads
+ * @param {bool} pinned: if true, thread t is pinned to CPU t
+ * @param {long} operations_per_thread: the number of updates per thread
+ * @param {std::function<void(int, int)>} update: offers value to the shared maxima on behalf of thread_id
+ * @param {std::function<int()>} read: returns the final shared maxima
+ * @return {run_result} throughput, latency percentiles and whether the final maxima is right;
+ *                      zero throughput and latencies when operations_per_thread is 0
+ */
+run_result run_benchmark(int num_of_threads, bool pinned, long operations_per_thread,
+                         const std::function<void(int, int)>& update, const std::function<int()>& read) {
+
+    std::atomic<int> ready(0);
+    std::atomic<bool> go(false);
+    std::vector<std::vector<double>> latencies(num_of_threads);
+    std::chrono::steady_clock::time_point start_time;
+
+    auto worker = [&](int thread_id) -> void {
+        if ( pinned ) {
+            pin_to_cpu(thread_id);
+        }
+        std::vector<double>& samples = latencies[thread_id];
+        samples.reserve(operations_per_thread / LATENCY_SAMPLE_PERIOD + 1);
+        ready.fetch_add(1);
+        int spins = 0;
+        while ( !go.load(std::memory_order_acquire) ) {
+            cpu_relax(spins);
+        }
+        for ( long i = 0; i < operations_per_thread; i++ ) {
+            // increasing values, distinct across threads: every offer raises the maxima of its thread
+            const int value = (int)(i * num_of_threads + thread_id);
+            if ( i % LATENCY_SAMPLE_PERIOD == 0 ) {
+                std::chrono::steady_clock::time_point before = std::chrono::steady_clock::now();
+                update(thread_id, value);
+                std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - before;
+                samples.push_back(elapsed.count());
+            }
+            else {
+                update(thread_id, value);
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for ( int thread_id = 0; thread_id < num_of_threads; thread_id++ ) {
+        threads.emplace_back(worker, thread_id);
+    }
+    while ( ready.load() < num_of_threads ) {
+        std::this_thread::yield();
+    }
+    start_time = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for ( std::thread& thread : threads ) {
+        thread.join();
+    }
+    std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start_time;
+
+    std::vector<double> all_samples;
+    for ( const auto& samples : latencies ) {
+        all_samples.insert(all_samples.end(), samples.begin(), samples.end());
+    }
+    std::sort(all_samples.begin(), all_samples.end());
+
+    run_result result;
+    result.operations_per_second = num_of_threads * operations_per_thread / duration.count();
+    // no operations, no samples: report zero latencies rather than read past the end
+    result.p50_nanoseconds = all_samples.empty() ? 0 : all_samples[all_samples.size() / 2];
+    result.p99_nanoseconds = all_samples.empty() ? 0 : all_samples[std::min(all_samples.size() - 1, all_samples.size() * 99 / 100)];
+    result.correct = read() == (int)(operations_per_thread * num_of_threads - 1);
+    return result;
+}
+
+/**
+ * @description: run every primitive at one thread count and print one row per primitive
+ */
+void benchmark_all(int num_of_threads, bool pinned, long operations_per_thread) {
+
+    auto print = [num_of_threads, pinned](const std::string& name, const run_result& result) {
+        std::cout << std::left << std::setw(14) << name
+                  << std::right << std::setw(8) << num_of_threads
+                  << std::setw(8) << (pinned ? "yes" : "no")
+                  << std::setw(14) << std::fixed << std::setprecision(2) << result.operations_per_second / 1e6
+                  << std::setw(12) << std::setprecision(0) << result.p50_nanoseconds
+                  << std::setw(12) << result.p99_nanoseconds
+                  << std::setw(9) << (result.correct ? "true" : "false") << std::endl;
+    };
+
+    {
+        std::mutex mutex;
+        int maxima = -1;
+        print("mutex", run_benchmark(num_of_threads, pinned, operations_per_thread,
+            [&](int, int value) {
+                const std::lock_guard<std::mutex> lock(mutex);
+                if ( value > maxima ) {
+                    maxima = value;
+                }
+            },
+            [&]() { return maxima; }));
+    }
+    {
+        spin_lock lock;
+        int maxima = -1;
+        print("spinlock", run_benchmark(num_of_threads, pinned, operations_per_thread,
+            [&](int, int value) {
+                lock.lock();
+                if ( value > maxima ) {
+                    maxima = value;
+                }
+                lock.unlock();
+            },
+            [&]() { return maxima; }));
+    }
+    {
+        ticket_lock lock;
+        int maxima = -1;
+        print("ticket lock", run_benchmark(num_of_threads, pinned, operations_per_thread,
+            [&](int, int value) {
+                lock.lock();
+                if ( value > maxima ) {
+                    maxima = value;
+                }
+                lock.unlock();
+            },
+            [&]() { return maxima; }));
+    }
+    {
+        mcs_lock lock;
+        std::vector<mcs_lock::node> nodes(num_of_threads);
+        int maxima = -1;
+        print("MCS lock", run_benchmark(num_of_threads, pinned, operations_per_thread,
+            [&](int thread_id, int value) {
+                lock.lock(nodes[thread_id]);
+                if ( value > maxima ) {
+                    maxima = value;
+                }
+                lock.unlock(nodes[thread_id]);
+            },
+            [&]() { return maxima; }));
+    }
+    {
+        std::atomic<int> maxima(-1);
+        print("CAS loop", run_benchmark(num_of_threads, pinned, operations_per_thread,
+            [&](int, int value) {
+                int expected = maxima.load();
+                while ( !maxima.compare_exchange_weak(expected, std::max(expected, value)) );
+            },
+            [&]() { return maxima.load(); }));
+    }
+    {
+        std::atomic<int> maxima(-1);
+        print("fetch_max", run_benchmark(num_of_threads, pinned, operations_per_thread,
+            [&](int, int value) {
+                int expected = maxima.load(std::memory_order_relaxed);
+                while ( value > expected && !maxima.compare_exchange_weak(expected, value, std::memory_order_relaxed) );
+            },
+            [&]() { return maxima.load(); }));
+    }
+    {
+        const int num_of_shards = std::max(1, num_of_threads / 4);
+        std::vector<padded<std::atomic<int>>> shards(num_of_shards);
+        for ( auto& shard : shards ) {
+            shard.value.store(-1);
+        }
+        print("sharded", run_benchmark(num_of_threads, pinned, operations_per_thread,
+            [&](int thread_id, int value) {
+                std::atomic<int>& shard = shards[thread_id % num_of_shards].value;
+                int expected = shard.load(std::memory_order_relaxed);
+                while ( value > expected && !shard.compare_exchange_weak(expected, value, std::memory_order_relaxed) );
+            },
+            [&]() {
+                int maxima = -1;
+                for ( auto& shard : shards ) {
+                    maxima = std::max(maxima, shard.value.load());
+                }
+                return maxima;
+            }));
+    }
+    {
+        // adjacent ints: each thread writes only its own, but the cache line ping-pongs
+        std::vector<std::atomic<int>> slots(num_of_threads);
+        for ( auto& slot : slots ) {
+            slot.store(-1);
+        }
+        print("slots packed", run_benchmark(num_of_threads, pinned, operations_per_thread,
+            [&](int thread_id, int value) {
+                if ( value > slots[thread_id].load(std::memory_order_relaxed) ) {
+                    slots[thread_id].store(value, std::memory_order_relaxed);
+                }
+            },
+            [&]() {
+                int maxima = -1;
+                for ( auto& slot : slots ) {
+                    maxima = std::max(maxima, slot.load());
+                }
+                return maxima;
+            }));
+    }
+    {
+        std::vector<padded<std::atomic<int>>> slots(num_of_threads);
+        for ( auto& slot : slots ) {
+            slot.value.store(-1);
+        }
+        print("slots padded", run_benchmark(num_of_threads, pinned, operations_per_thread,
+            [&](int thread_id, int value) {
+                if ( value > slots[thread_id].value.load(std::memory_order_relaxed) ) {
+                    slots[thread_id].value.store(value, std::memory_order_relaxed);
+                }
+            },
+            [&]() {
+                int maxima = -1;
+                for ( auto& slot : slots ) {
+                    maxima = std::max(maxima, slot.value.load());
+                }
+                return maxima;
+            }));
+    }
+}
+
+
+int main(int argc, char* argv[]) {
+
+    const long operations_per_thread = argc > 1 ? std::stol(argv[1]) : 1 << 20;
+    const int max_num_of_threads = argc > 2 ? std::stoi(argv[2]) : (int)std::max(1u, std::thread::hardware_concurrency());
+
+    if ( operations_per_thread < 0 || max_num_of_threads < 1 ) {
+        std::cout << "the number of operations must be at least 0 and the number of threads at least 1." << std::endl;
+        return -1;
+    }
+
+    std::cout << "operations per thread: " << operations_per_thread << std::endl;
+    std::cout << "latency: one operation in " << LATENCY_SAMPLE_PERIOD << " is timed" << std::endl;
+    std::cout << "============================================" << std::endl;
+    std::cout << std::left << std::setw(14) << "primitive"
+              << std::right << std::setw(8) << "threads"
+              << std::setw(8) << "pinned"
+              << std::setw(14) << "Mops/s"
+              << std::setw(12) << "p50 (ns)"
+              << std::setw(12) << "p99 (ns)"
+              << std::setw(9) << "correct" << std::endl;
+
+    std::vector<int> thread_counts;
+    for ( int num_of_threads = 1; num_of_threads < max_num_of_threads; num_of_threads *= 2 ) {
+        thread_counts.push_back(num_of_threads);
+    }
+    thread_counts.push_back(max_num_of_threads);
+
+    for ( bool pinned : {false, true} ) {
+        for ( int num_of_threads : thread_counts ) {
+            benchmark_all(num_of_threads, pinned, operations_per_thread);
+        }
+    }
+
+    return 0;
+}
@@ -2,6 +2,8 @@
 #include <chrono>       /* time manipulation */
 #include <omp.h>        /* openMP */
 
+#include "openMP_cost_model.cpp"
+
 /**
  * @description: multiply A * B in the ordinary fashion
  * @param {long int*} A: matrix A 
@@ -29,13 +31,10 @@ void sequential_matrix_multiplication(long int* A, long int* B, long int* C, int
  * @param {long int*} A: matrix A 
  * @param {long int*} B: matrix B
  * @param {int} matrix_size: the size of the matrix
+ * @param {int} num_of_threads: the number of threads
  * @return {long int*} the result of A * B 
  */
-void openMP_matrix_multiplication(long int* A, long int* B, long int* C, int matrix_size) {
-    
-    // maximum number of threads
-    const int max_num_of_threads = omp_get_max_threads();
-    std::cout<< "number of threads: " << max_num_of_threads << std::endl;
+void openMP_matrix_multiplication(long int* A, long int* B, long int* C, int matrix_size, int num_of_threads) {
 
     int i = 0;
     int j = 0;
@@ -43,7 +42,7 @@ void openMP_matrix_multiplication(long int* A, long int* B, long int* C, int mat
     long int temp_sum = 0;
 
     // perform matrix multiplication
-    #pragma omp parallel for private(j) private(k) private(temp_sum) num_threads(max_num_of_threads)
+    #pragma omp parallel for private(j) private(k) private(temp_sum) num_threads(num_of_threads)
     for ( i = 0; i < matrix_size; i++ ) {
         for ( j = 0; j < matrix_size; j++ ) {
             temp_sum = 0;
@@ -57,6 +56,70 @@ void openMP_matrix_multiplication(long int* A, long int* B, long int* C, int mat
 }
 
 
+/**
+ * @description: multiply A * B with openMP API, with the maximum number of threads
+ * @param {long int*} A: matrix A 
+ * @param {long int*} B: matrix B
+ * @param {int} matrix_size: the size of the matrix
+ * @return {long int*} the result of A * B 
+ */
+void openMP_matrix_multiplication(long int* A, long int* B, long int* C, int matrix_size) {
+    
+    // maximum number of threads
+    const int max_num_of_threads = omp_get_max_threads();
+    std::cout<< "number of threads: " << max_num_of_threads << std::endl;
+
+    openMP_matrix_multiplication(A, B, C, matrix_size, max_num_of_threads);
+}
+
+
+/**
+ * @description: calibrate the sequential matrix multiplication kernel, per multiply-add, unless it is cached
+ * @param {CostModel&} model: the cost model to calibrate
+ */
+void calibrate_matrix_multiplication(CostModel& model) {
+    const int sample_size = 1 << 6;
+    long int* A = new long int[sample_size * sample_size];
+    long int* B = new long int[sample_size * sample_size];
+    long int* C = new long int[sample_size * sample_size];
+    for ( int i = 0; i < sample_size * sample_size; i++ ) {
+        A[i] = i + 1;
+        B[i] = sample_size * sample_size - i;
+    }
+    const double work = (double)sample_size * sample_size * sample_size;
+    model.calibrate_kernel("matmul", work, [A, B, C, sample_size]() {
+        sequential_matrix_multiplication(A, B, C, sample_size);
+    });
+    delete[] A;
+    delete[] B;
+    delete[] C;
+}
+
+
+/**
+ * @description: multiply A * B, sequentially or with openMP and the number of threads
+ *               the cost model predicts is fastest for matrix_size^3 multiply-adds
+ * @param {long int*} A: matrix A 
+ * @param {long int*} B: matrix B
+ * @param {int} matrix_size: the size of the matrix
+ * @param {const CostModel&} model: a cost model calibrated by calibrate_matrix_multiplication
+ * @return {long int*} the result of A * B 
+ */
+void dispatched_matrix_multiplication(long int* A, long int* B, long int* C, int matrix_size, const CostModel& model) {
+
+    const double work = (double)matrix_size * matrix_size * matrix_size;
+    const int num_of_threads = model.choose_threads("openmp", "matmul", work);
+    std::cout<< "number of threads: " << num_of_threads << std::endl;
+
+    if ( num_of_threads == 1 ) {
+        sequential_matrix_multiplication(A, B, C, matrix_size);
+    }
+    else {
+        openMP_matrix_multiplication(A, B, C, matrix_size, num_of_threads);
+    }
+}
+
+
 /**
  * @description: validate the result from two matrix multiplication method
  * @param {long int*} A: matrix A
@@ -125,5 +188,18 @@ int main() {
     // validate result
     validate_result(C, C_openMP, matrix_size);
 
+    // cost model dispatched version, reusing C_openMP: every entry is overwritten
+    CostModel model = openMP_cost_model();
+    calibrate_matrix_multiplication(model);
+    model.save();
+    start_time = std::chrono::steady_clock::now();
+    std::cout << "Running cost model dispatched version: " << std::endl;
+    dispatched_matrix_multiplication(A, B, C_openMP, matrix_size, model);
+    end_time = std::chrono::steady_clock::now();
+    duration = end_time - start_time; 
+    std::cout << "it takes " << duration.count() << " seconds." << std::endl;
+    std::cout << "============================================" << std::endl;
+    validate_result(C, C_openMP, matrix_size);
+
     return 0;
 }
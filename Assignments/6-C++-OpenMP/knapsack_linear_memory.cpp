@@ -0,0 +1,156 @@
+#include <vector>
+#include <algorithm>    // std::max
+#include <utility>      // std::swap
+#include <omp.h>        /* openMP */
+
+/*
+    Pseudo polynomial knapsack in O(C) memory.
+
+    Row i of the table only depends on row i-1, so the optimum needs one row of C+1 cells. The row is updated
+    from j = C down to j = w[i-1], which reads m[i-1][j - w[i-1]] before it is overwritten. The openMP version
+    keeps two rows instead, because its threads update different capacities of a row at the same time.
+
+    The chosen items are recovered by divide and conquer, as in Hirschberg's algorithm. To pick items
+    [lo, hi) within capacity c:
+        - forward[k]  = best value of items [lo, mid) within capacity k, for k = 0 ... c,
+        - backward[k] = best value of items [mid, hi) within capacity k,
+        - the optimum splits the capacity at the k that maximizes forward[k] + backward[c - k],
+    and the two halves are solved again with capacities k and c - k. The capacities of the sub-problems on
+    one level sum to at most C, so every level costs at most N * C cells and all levels about 2 N * C.
+    Both rows are freed before the recursion, so the extra memory is O(C) per running task.
+*/
+
+const int KNAPSACK_TASK_CELLS = 1 << 16;    // sub-problems with fewer cells than this do not spawn tasks
+
+
+/**
+ * @description: one row of pseudo polynomial knapsack in O(C) memory
+ * @param {int* w} a constant and non-negative array of length N
+ * @param {int* v} a constant and non-negative array of length N
+ * @param {int C} the capacity
+ * @param {int N} the number of items
+ * @return {std::vector<int>} the last row m[N][0 ... C] of the full table
+*/
+std::vector<int> linear_memory_pseudo_polynomial_knapsack_row(const int* w, const int* v, int C, int N) {
+    std::vector<int> row(C + 1, 0);
+    for ( int i = 0; i < N; i++ ) {
+        // downwards, so that row[j - w[i]] still holds the previous row
+        for ( int j = C; j >= w[i]; j-- ) {
+            row[j] = MAX(row[j], row[j - w[i]] + v[i]);
+        }
+    }
+    return row;
+}
+
+/**
+ * @description: sequential version of pseudo polynomial knapsack in O(C) memory
+ * @param {int* w} a constant and non-negative array of length N
+ * @param {int* v} a constant and non-negative array of length N
+ * @return {int} the optimum, m[AT(N, C)] of the full table
+*/
+int linear_memory_pseudo_polynomial_knapsack(int* w, int* v, int C, int N) {
+    return linear_memory_pseudo_polynomial_knapsack_row(w, v, C, N)[C];
+}
+
+/**
+ * @description: openMP version of pseudo polynomial knapsack in O(C) memory, two rows in one parallel region
+ * @param {int* w} a constant and non-negative array of length N
+ * @param {int* v} a constant and non-negative array of length N
+ * @param {int num_of_threads} the number of threads
+ * @return {int} the optimum, m[AT(N, C)] of the full table
+*/
+int openMP_linear_memory_pseudo_polynomial_knapsack(int* w, int* v, int C, int N, int num_of_threads) {
+    std::vector<int> previous(C + 1, 0);
+    std::vector<int> current(C + 1, 0);
+
+    #pragma omp parallel num_threads(num_of_threads)
+    {
+        // every thread swaps its own copy of the row pointers after the implicit barrier that ends a row
+        int* p = previous.data();
+        int* q = current.data();
+        for ( int i = 1; i < N + 1; i++ ) {
+            #pragma omp for schedule(static)
+            for ( int j = 0; j < C + 1; j++ ) {
+                q[j] = w[i-1] <= j ? MAX(p[j], p[j - w[i-1]] + v[i-1]) : p[j];
+            }
+            std::swap(p, q);
+        }
+    }
+    return N % 2 == 0 ? previous[C] : current[C];
+}
+
+
+/**
+ * @description: choose items [lo, hi) within capacity c, appending their indices to chosen
+ */
+void hirschberg_knapsack(const int* w, const int* v, int lo, int hi, int c, std::vector<int>& chosen) {
+    if ( hi - lo == 1 ) {
+        if ( w[lo] <= c && v[lo] > 0 ) {
+            chosen.push_back(lo);
+        }
+        return;
+    }
+
+    const int mid = lo + (hi - lo) / 2;
+    const bool large = (long long)(hi - lo) * (c + 1) >= KNAPSACK_TASK_CELLS;
+    int split = 0;
+    {
+        std::vector<int> forward;
+        std::vector<int> backward;
+        #pragma omp task shared(forward) if(large)
+        forward = linear_memory_pseudo_polynomial_knapsack_row(w + lo, v + lo, c, mid - lo);
+        backward = linear_memory_pseudo_polynomial_knapsack_row(w + mid, v + mid, c, hi - mid);
+        #pragma omp taskwait
+
+        int best = -1;
+        for ( int k = 0; k <= c; k++ ) {
+            if ( forward[k] + backward[c - k] > best ) {
+                best = forward[k] + backward[c - k];
+                split = k;
+            }
+        }
+    }
+
+    std::vector<int> chosen_right;
+    #pragma omp task shared(chosen) if(large)
+    hirschberg_knapsack(w, v, lo, mid, split, chosen);
+    hirschberg_knapsack(w, v, mid, hi, c - split, chosen_right);
+    #pragma omp taskwait
+    chosen.insert(chosen.end(), chosen_right.begin(), chosen_right.end());
+}
+
+/**
+ * @description: items of an optimal knapsack, reconstructed in O(C) memory per thread
+ * @param {int* w} a constant and non-negative array of length N
+ * @param {int* v} a constant and non-negative array of length N
+ * @param {int num_of_threads} the number of threads
+ * @return {std::vector<int>} the indices of the chosen items, in increasing order
+*/
+std::vector<int> linear_memory_pseudo_polynomial_knapsack_items(int* w, int* v, int C, int N, int num_of_threads) {
+    std::vector<int> chosen;
+    if ( N == 0 ) {
+        return chosen;
+    }
+    #pragma omp parallel num_threads(num_of_threads)
+    {
+        #pragma omp single
+        hirschberg_knapsack(w, v, 0, N, C, chosen);
+    }
+    return chosen;
+}
+
+/**
+ * @description: check that a set of items fits within the capacity and reaches the expected value
+ * @param {std::vector<int>} chosen: the indices of the chosen items
+ * @param {int} optimum: the expected total value
+ * @return {bool} if the item set is correct, return true
+ */
+bool validate_items(int* w, int* v, int C, const std::vector<int>& chosen, int optimum) {
+    long long weight = 0;
+    long long value = 0;
+    for ( int i : chosen ) {
+        weight += w[i];
+        value += v[i];
+    }
+    return weight <= C && value == optimum;
+}
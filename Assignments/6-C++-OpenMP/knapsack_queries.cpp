@@ -0,0 +1,159 @@
+#include <vector>
+#include <cstdint>
+#include <algorithm>    // std::min, std::max
+#include <utility>      // std::swap
+#include <omp.h>        /* openMP */
+
+/*
+    Knapsack table built once, up to a maximum capacity, and queried for many capacities.
+
+    Row N of the full table answers the optimum for every capacity at once. To recover the items, only one
+    bit per cell of the rest of the table is needed: cell (i, j) is taken if m[AT(i, j)] != m[AT(i-1, j)],
+    that is, if item i-1 is in the optimal set within capacity j of the first i items. The structure keeps
+    the last row and these bits, in the same row-major layout as AT(i, j), rounded up to whole 64-bit words
+    per row. That is 32 times smaller than the int table.
+
+    A query for capacity c walks the bits from row N up: if (i, c) is taken, item i-1 is chosen and c drops
+    by w[i-1]. This is O(N) per query, and the queries of a batch are answered in parallel. New items extend
+    the structure from the retained last row. Nothing is recomputed.
+*/
+
+class knapsack_query_table {
+
+public:
+
+    /**
+     * @description: constructor, an empty item set
+     * @param {int} max_capacity: the largest capacity that will be queried
+     * @param {int} num_of_threads: the number of threads for building rows and answering batches
+     */
+    knapsack_query_table(int max_capacity, int num_of_threads) :
+        max_capacity(max_capacity),
+        num_of_threads(std::max(1, num_of_threads)),
+        words_per_row((max_capacity + 1 + 63) / 64),
+        last_row(max_capacity + 1, 0),
+        next_row(max_capacity + 1, 0) {
+    }
+
+    /**
+     * @description: add items and extend the table by one row each
+     * @param {int* w} a constant and non-negative array of length count
+     * @param {int* v} a constant and non-negative array of length count
+     * @param {int} count: the number of new items
+     */
+    void append_items(const int* w, const int* v, int count) {
+        const int C = max_capacity;
+        const size_t first_new_row = weights.size();
+        weights.insert(weights.end(), w, w + count);
+        values.insert(values.end(), v, v + count);
+        taken.resize(weights.size() * words_per_row, 0);
+
+        #pragma omp parallel num_threads(num_of_threads)
+        {
+            // every thread owns whole words of every row, so the bits of different threads never share a word
+            const int thread_id = omp_get_thread_num();
+            const int team_size = omp_get_num_threads();
+            const size_t first_word = words_per_row * thread_id / team_size;
+            const size_t last_word = words_per_row * (thread_id + 1) / team_size;
+            const int first_j = (int)(64 * first_word);
+            const int last_j = std::min(C, (int)(64 * last_word) - 1);
+
+            int* previous = last_row.data();
+            int* current = next_row.data();
+            for ( size_t i = first_new_row; i < weights.size(); i++ ) {
+                if ( first_j <= last_j ) {
+                    knapsack_row_kernel(previous, current, first_j, last_j, weights[i], values[i]);
+                    uint64_t* bits = taken.data() + i * words_per_row;
+                    for ( int j = first_j; j <= last_j; j++ ) {
+                        if ( current[j] != previous[j] ) {
+                            bits[j / 64] |= 1ULL << (j % 64);
+                        }
+                    }
+                }
+                // the barrier ends the row; every thread swaps its own copy of the row pointers
+                std::swap(previous, current);
+                #pragma omp barrier
+            }
+        }
+        if ( count % 2 == 1 ) {
+            last_row.swap(next_row);
+        }
+    }
+
+    int num_of_items() const {
+        return (int)weights.size();
+    }
+
+    /**
+     * @description: the optimum within a capacity, m[AT(N, capacity)] of the full table
+     * @return {int} the optimum, -1 if the capacity is negative or above the maximum capacity
+     */
+    int optimum(int capacity) const {
+        if ( capacity < 0 || capacity > max_capacity ) {
+            return -1;
+        }
+        return last_row[capacity];
+    }
+
+    /**
+     * @description: the items of an optimal knapsack within a capacity
+     * @return {std::vector<int>} the indices of the chosen items in decreasing order, empty for invalid capacities
+     */
+    std::vector<int> items(int capacity) const {
+        std::vector<int> chosen;
+        if ( capacity < 0 || capacity > max_capacity ) {
+            return chosen;
+        }
+        int j = capacity;
+        for ( size_t i = weights.size(); i-- > 0; ) {
+            if ( (taken[i * words_per_row + j / 64] >> (j % 64)) & 1 ) {
+                chosen.push_back((int)i);
+                j -= weights[i];
+            }
+        }
+        return chosen;
+    }
+
+    /**
+     * @description: the optimum for every capacity of a batch
+     */
+    std::vector<int> optimum_batch(const std::vector<int>& capacities) const {
+        std::vector<int> answers(capacities.size());
+        for ( size_t q = 0; q < capacities.size(); q++ ) {
+            answers[q] = optimum(capacities[q]);
+        }
+        return answers;
+    }
+
+    /**
+     * @description: the items of an optimal knapsack for every capacity of a batch, reconstructed in parallel
+     */
+    std::vector<std::vector<int>> items_batch(const std::vector<int>& capacities) const {
+        std::vector<std::vector<int>> answers(capacities.size());
+        const long long num_of_queries = (long long)capacities.size();
+        #pragma omp parallel for schedule(dynamic, 16) num_threads(num_of_threads)
+        for ( long long q = 0; q < num_of_queries; q++ ) {
+            answers[q] = items(capacities[q]);
+        }
+        return answers;
+    }
+
+    /**
+     * @description: the memory held by the table, in bytes
+     */
+    size_t memory_size() const {
+        return taken.size() * sizeof(uint64_t) + (last_row.size() + next_row.size()) * sizeof(int)
+             + (weights.size() + values.size()) * sizeof(int);
+    }
+
+private:
+
+    const int max_capacity;
+    const int num_of_threads;
+    const size_t words_per_row;
+    std::vector<int> weights;
+    std::vector<int> values;
+    std::vector<int> last_row;          // m[AT(N, 0 ... max_capacity)]
+    std::vector<int> next_row;          // scratch space for appending
+    std::vector<uint64_t> taken;        // bit (i, j) in word i * words_per_row + j / 64
+};
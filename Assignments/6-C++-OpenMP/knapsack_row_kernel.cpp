@@ -0,0 +1,179 @@
+#include <iostream>
+#include <chrono>       /* time manipulation */
+#include <vector>
+#include <cstring>      // std::memcpy
+#include <cstdint>
+#include <algorithm>    // std::min, std::max
+#include <omp.h>        /* openMP */
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>  // AVX2 and AVX-512 intrinsics
+#endif
+
+/*
+    Branchless row update of the pseudo polynomial knapsack.
+
+    For one item of weight w and value v, a row is
+        current[j] = previous[j]                                   for j < w
+        current[j] = max(previous[j], previous[j - w] + v)         for j >= w
+    which is a copy followed by a shifted elementwise max-plus. knapsack_row_kernel copies the prefix and runs
+    the max-plus with AVX-512 when the compiler targets it (16 int32 or 8 int64 lanes), otherwise with AVX2
+    (8 int32 or 4 int64 lanes, int64 max via compare and blend), and with a scalar loop for the remainder.
+    Compile with -march=native to enable the vector paths.
+*/
+
+/**
+ * @description: vector max-plus over [j, last_j] for int32, returns the first j it did not process
+ */
+inline int knapsack_row_max_plus(const int32_t* previous, int32_t* current, int j, int last_j, int weight, int32_t value) {
+#ifdef __AVX512F__
+    const __m512i values_512 = _mm512_set1_epi32(value);
+    for ( ; j + 16 <= last_j + 1; j += 16 ) {
+        __m512i keep = _mm512_loadu_si512((const void*)(previous + j));
+        __m512i take = _mm512_add_epi32(_mm512_loadu_si512((const void*)(previous + j - weight)), values_512);
+        _mm512_storeu_si512((void*)(current + j), _mm512_max_epi32(keep, take));
+    }
+#endif
+#ifdef __AVX2__
+    const __m256i values_256 = _mm256_set1_epi32(value);
+    for ( ; j + 8 <= last_j + 1; j += 8 ) {
+        __m256i keep = _mm256_loadu_si256((const __m256i*)(previous + j));
+        __m256i take = _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(previous + j - weight)), values_256);
+        _mm256_storeu_si256((__m256i*)(current + j), _mm256_max_epi32(keep, take));
+    }
+#endif
+    return j;
+}
+
+/**
+ * @description: vector max-plus over [j, last_j] for int64, returns the first j it did not process
+ */
+inline int knapsack_row_max_plus(const int64_t* previous, int64_t* current, int j, int last_j, int weight, int64_t value) {
+#ifdef __AVX512F__
+    const __m512i values_512 = _mm512_set1_epi64(value);
+    for ( ; j + 8 <= last_j + 1; j += 8 ) {
+        __m512i keep = _mm512_loadu_si512((const void*)(previous + j));
+        __m512i take = _mm512_add_epi64(_mm512_loadu_si512((const void*)(previous + j - weight)), values_512);
+        _mm512_storeu_si512((void*)(current + j), _mm512_max_epi64(keep, take));
+    }
+#endif
+#ifdef __AVX2__
+    const __m256i values_256 = _mm256_set1_epi64x(value);
+    for ( ; j + 4 <= last_j + 1; j += 4 ) {
+        __m256i keep = _mm256_loadu_si256((const __m256i*)(previous + j));
+        __m256i take = _mm256_add_epi64(_mm256_loadu_si256((const __m256i*)(previous + j - weight)), values_256);
+        _mm256_storeu_si256((__m256i*)(current + j), _mm256_blendv_epi8(keep, take, _mm256_cmpgt_epi64(take, keep)));
+    }
+#endif
+    return j;
+}
+
+/**
+ * @description: one knapsack row over the capacities [first_j, last_j]
+ * @param {const T*} previous: row i-1
+ * @param {T*} current: row i, must not overlap previous
+ * @param {int} first_j: the first capacity to compute
+ * @param {int} last_j: the last capacity to compute
+ * @param {int} weight: w[i-1]
+ * @param {T} value: v[i-1]
+ */
+template <typename T>
+void knapsack_row_kernel(const T* previous, T* current, int first_j, int last_j, int weight, T value) {
+    int j = first_j;
+    const int prefix_end = std::min(last_j + 1, std::max(first_j, weight));
+    if ( prefix_end > j ) {
+        std::memcpy(current + j, previous + j, sizeof(T) * (prefix_end - j));
+        j = prefix_end;
+    }
+    j = knapsack_row_max_plus(previous, current, j, last_j, weight, value);
+    for ( ; j <= last_j; j++ ) {
+        T take = previous[j - weight] + value;
+        current[j] = previous[j] < take ? take : previous[j];
+    }
+}
+
+
+/**
+ * @description: sequential version of pseudo polynomial knapsack with the vectorized row kernel
+ * @param {int* w} a constant and non-negative array of length N
+ * @param {T* v} a constant and non-negative array of length N
+ * @param {T* m} an array of length (C+1)*(N+1) initialized with zeros
+*/
+template <typename T>
+void vectorized_pseudo_polynomial_knapsack(int* w, T* v, T* m, int C, int N) {
+    for ( int i = 1; i < N + 1; i++ ) {
+        knapsack_row_kernel(m + AT(i-1, 0), m + AT(i, 0), 0, C, w[i-1], v[i-1]);
+    }
+}
+
+/**
+ * @description: openMP version of pseudo polynomial knapsack with the vectorized row kernel,
+ *               one parallel region in which every thread computes a fixed slice of each row
+ * @param {int* w} a constant and non-negative array of length N
+ * @param {T* v} a constant and non-negative array of length N
+ * @param {T* m} an array of length (C+1)*(N+1) initialized with zeros
+ * @param {int num_of_threads} the number of threads
+*/
+template <typename T>
+void openMP_vectorized_pseudo_polynomial_knapsack(int* w, T* v, T* m, int C, int N, int num_of_threads) {
+    #pragma omp parallel num_threads(num_of_threads)
+    {
+        const int thread_id = omp_get_thread_num();
+        const int team_size = omp_get_num_threads();
+        // slices are a whole number of cache lines long, so neighbouring threads share at most one line per row
+        const int line = 64 / (int)sizeof(T);
+        const int slice = ((C + 1 + team_size - 1) / team_size + line - 1) / line * line;
+        const int first_j = thread_id * slice;
+        const int last_j = std::min(C, first_j + slice - 1);
+
+        for ( int i = 1; i < N + 1; i++ ) {
+            if ( first_j <= last_j ) {
+                knapsack_row_kernel(m + AT(i-1, 0), m + AT(i, 0), first_j, last_j, w[i-1], v[i-1]);
+            }
+            #pragma omp barrier
+        }
+    }
+}
+
+
+/**
+ * @description: cells per second of the scalar row and of the vectorized row kernel, on two rolling rows
+ * @param {int} C: the capacity
+ * @param {int} N: the number of items
+ */
+template <typename T>
+void benchmark_knapsack_row_kernel(int C, int N) {
+    std::vector<int> w(N);
+    std::vector<T> v(N);
+    random_fill_integers(w.data(), N, 1, 1 + C / 4, DEFAULT_RANDOM_SEED + 8, omp_get_max_threads());
+    random_fill_integers(v.data(), N, 0, 1000, DEFAULT_RANDOM_SEED + 9, omp_get_max_threads());
+    std::vector<T> rows[2] = {std::vector<T>(C + 1, 0), std::vector<T>(C + 1, 0)};
+    std::vector<T> rows_vectorized[2] = {std::vector<T>(C + 1, 0), std::vector<T>(C + 1, 0)};
+
+    std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+    for ( int i = 1; i < N + 1; i++ ) {
+        const T* p = rows[(i - 1) % 2].data();
+        T* q = rows[i % 2].data();
+        for ( int j = 0; j < C + 1; j++ ) {
+            if ( w[i-1] <= j ) {
+                q[j] = MAX(p[j], p[j - w[i-1]] + v[i-1]);
+            }
+            else {
+                q[j] = p[j];
+            }
+        }
+    }
+    std::chrono::duration<double> scalar_time = std::chrono::steady_clock::now() - start_time;
+
+    start_time = std::chrono::steady_clock::now();
+    for ( int i = 1; i < N + 1; i++ ) {
+        knapsack_row_kernel(rows_vectorized[(i - 1) % 2].data(), rows_vectorized[i % 2].data(), 0, C, w[i-1], v[i-1]);
+    }
+    std::chrono::duration<double> vectorized_time = std::chrono::steady_clock::now() - start_time;
+
+    const double cells = (double)N * (C + 1);
+    std::cout << sizeof(T) * 8 << "-bit values, C = " << C << ", N = " << N << std::endl;
+    std::cout << "scalar row: " << cells / scalar_time.count() / 1e9 << " billion cells per second" << std::endl;
+    std::cout << "vectorized row kernel: " << cells / vectorized_time.count() / 1e9 << " billion cells per second" << std::endl;
+    std::cout << "validating results: " << std::boolalpha << (rows[N % 2] == rows_vectorized[N % 2]) << std::endl;
+    std::cout << "============================================" << std::endl;
+}
@@ -0,0 +1,283 @@
+#include <vector>
+#include <algorithm>    // std::sort, std::max, std::min, std::upper_bound
+#include <omp.h>        /* openMP */
+
+/*
+    Sparse pseudo polynomial knapsack for large capacities.
+
+    Row i of the dense table is a step function of the capacity. It only changes value at the weights of
+    its Pareto points: the (weight, value) pairs of item subsets that no lighter subset beats in value.
+    The engine keeps that list sorted by weight, with strictly increasing values, and processes one item
+    (w, v) as follows:
+        1. shift the points with weight <= C - w by (w, v),
+        2. merge the shifted list with the old one by weight,
+        3. drop every point whose value is not larger than the value of a lighter point.
+    The cost per item is the length of the list, not C, so C = 10^9 is fine as long as the frontier stays
+    small. Long lists are merged in parallel: every thread merges a slice found by a binary search along the
+    merge path, and the drop step is a scan over the slices carrying the running maximum value.
+
+    Before the DP,
+        - items heavier than C and items of value 0 are removed;
+        - an item is removed if the lighter-or-equal, at-least-as-valuable items kept before it are together
+          too heavy to all fit next to it. An optimal solution that uses it then leaves one of them out,
+          and can swap it in instead without losing value;
+        - the remaining items are sorted by value per weight, best first.
+    With upper bound pruning, a point (W, V) is also dropped when even filling the capacity left, C - W,
+    at the best value per weight among the items still to come cannot beat the best point so far.
+    The optimum is unchanged, but the list then no longer describes the whole dense row.
+*/
+
+const size_t SPARSE_PARALLEL_MERGE_SIZE = 1 << 15;  // by default, shorter lists are merged by one thread
+
+/**
+ * @description: the weight and value of a subset of items
+ */
+struct pareto_point {
+    long long weight;
+    long long value;
+};
+
+/**
+ * @description: result of the sparse knapsack, with statistics of the run
+ */
+struct sparse_knapsack_result {
+    long long optimum;
+    int num_of_items_kept;          // after removing heavy, worthless and dominated items
+    size_t max_frontier_size;       // the longest Pareto list during the DP
+};
+
+
+/**
+ * @description: merge order, lighter first and more valuable first among equal weights
+ */
+inline bool pareto_before(const pareto_point& a, const pareto_point& b) {
+    return a.weight < b.weight || (a.weight == b.weight && a.value > b.value);
+}
+
+/**
+ * @description: the k-th point of the shifted list
+ */
+inline pareto_point shifted_point(const std::vector<pareto_point>& frontier, size_t k, long long w, long long v) {
+    return {frontier[k].weight + w, frontier[k].value + v};
+}
+
+/**
+ * @description: how many points of the merge of frontier[0, na) and the shifted list [0, nb) come from frontier
+ *               among the first d, ties taken from frontier first
+ */
+size_t merge_path(const std::vector<pareto_point>& frontier, size_t na, size_t nb, long long w, long long v, size_t d) {
+    size_t lo = d > nb ? d - nb : 0;
+    size_t hi = std::min(d, na);
+    while ( lo < hi ) {
+        size_t i = lo + (hi - lo) / 2;
+        // frontier[i] is among the first d if it is not after shifted[d - i - 1]
+        if ( !pareto_before(shifted_point(frontier, d - i - 1, w, v), frontier[i]) ) {
+            lo = i + 1;
+        }
+        else {
+            hi = i;
+        }
+    }
+    return lo;
+}
+
+/**
+ * @description: process one item: merge the frontier with its copy shifted by (w, v) and keep the Pareto points
+ * @param {std::vector<pareto_point>&} frontier: the Pareto list, replaced by the new one
+ * @param {std::vector<pareto_point>&} merged: scratch space
+ * @param {size_t} parallel_merge_size: shorter merges are done by one thread
+ */
+void merge_pareto_frontier(std::vector<pareto_point>& frontier, std::vector<pareto_point>& merged,
+                           long long w, long long v, long long C, int num_of_threads, size_t parallel_merge_size) {
+    const size_t na = frontier.size();
+    // the shifted points that still fit are a prefix, because the frontier is sorted by weight
+    const size_t nb = std::upper_bound(frontier.begin(), frontier.end(), C - w,
+        [](long long limit, const pareto_point& point) { return limit < point.weight; }) - frontier.begin();
+    const size_t total = na + nb;
+    merged.resize(total);
+
+    if ( total < parallel_merge_size || num_of_threads < 2 ) {
+        size_t i = 0;
+        size_t j = 0;
+        size_t kept = 0;
+        long long best = -1;
+        while ( i < na || j < nb ) {
+            pareto_point point;
+            if ( j == nb || (i < na && !pareto_before(shifted_point(frontier, j, w, v), frontier[i])) ) {
+                point = frontier[i++];
+            }
+            else {
+                point = shifted_point(frontier, j++, w, v);
+            }
+            if ( point.value > best ) {
+                merged[kept++] = point;
+                best = point.value;
+            }
+        }
+        merged.resize(kept);
+        frontier.swap(merged);
+        return;
+    }
+
+    std::vector<long long> slice_max(num_of_threads, -1);
+    std::vector<size_t> slice_kept(num_of_threads + 1, 0);
+
+    #pragma omp parallel num_threads(num_of_threads)
+    {
+        const int thread_id = omp_get_thread_num();
+        const int team_size = omp_get_num_threads();
+        const size_t d_start = total * thread_id / team_size;
+        const size_t d_end = total * (thread_id + 1) / team_size;
+
+        // merge this slice of the merge path
+        size_t i = merge_path(frontier, na, nb, w, v, d_start);
+        size_t j = d_start - i;
+        long long maximum = -1;
+        for ( size_t d = d_start; d < d_end; d++ ) {
+            if ( j == nb || (i < na && !pareto_before(shifted_point(frontier, j, w, v), frontier[i])) ) {
+                merged[d] = frontier[i++];
+            }
+            else {
+                merged[d] = shifted_point(frontier, j++, w, v);
+            }
+            maximum = std::max(maximum, merged[d].value);
+        }
+        slice_max[thread_id] = maximum;
+        #pragma omp barrier
+
+        // keep a point if it beats every lighter point, in this slice and in the slices before it
+        long long best = -1;
+        for ( int t = 0; t < thread_id; t++ ) {
+            best = std::max(best, slice_max[t]);
+        }
+        size_t kept = d_start;
+        for ( size_t d = d_start; d < d_end; d++ ) {
+            if ( merged[d].value > best ) {
+                merged[kept++] = merged[d];
+                best = merged[d].value;
+            }
+        }
+        slice_kept[thread_id + 1] = kept - d_start;
+        #pragma omp barrier
+
+        #pragma omp single
+        {
+            for ( int t = 0; t < team_size; t++ ) {
+                slice_kept[t + 1] += slice_kept[t];
+            }
+            frontier.resize(slice_kept[team_size]);
+        }
+
+        std::copy(merged.begin() + d_start, merged.begin() + d_start + (slice_kept[thread_id + 1] - slice_kept[thread_id]),
+                  frontier.begin() + slice_kept[thread_id]);
+    }
+}
+
+
+/**
+ * @description: remove items that cannot improve the optimum, the order of the rest is unspecified
+ * @return {std::vector<int>} the indices of the kept items
+ */
+std::vector<int> prune_knapsack_items(const int* w, const int* v, long long C, int N) {
+    std::vector<int> items;
+    for ( int i = 0; i < N; i++ ) {
+        if ( w[i] <= C && v[i] > 0 ) {
+            items.push_back(i);
+        }
+    }
+    // lighter first, more valuable first among equal weights; then every possible dominator comes earlier
+    std::sort(items.begin(), items.end(), [w, v](int a, int b) {
+        return w[a] < w[b] || (w[a] == w[b] && (v[a] > v[b] || (v[a] == v[b] && a < b)));
+    });
+
+    // Fenwick tree over the value ranks: the total weight of the kept items with at least a given value
+    std::vector<int> values;
+    for ( int i : items ) {
+        values.push_back(v[i]);
+    }
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+    const int num_of_values = (int)values.size();
+    std::vector<long long> tree(num_of_values + 1, 0);
+
+    std::vector<int> kept;
+    for ( int i : items ) {
+        // rank counted from the largest value, so a prefix sum covers the values >= v[i]
+        int rank = num_of_values - (int)(std::lower_bound(values.begin(), values.end(), v[i]) - values.begin());
+        long long dominators_weight = 0;
+        for ( int k = rank; k > 0; k -= k & -k ) {
+            dominators_weight += tree[k];
+        }
+        if ( dominators_weight + w[i] > C ) {
+            continue;
+        }
+        kept.push_back(i);
+        for ( int k = rank; k <= num_of_values; k += k & -k ) {
+            tree[k] += w[i];
+        }
+    }
+    return kept;
+}
+
+/**
+ * @description: sparse version of pseudo polynomial knapsack, for capacities far beyond a dense table
+ * @param {int* w} a constant and non-negative array of length N
+ * @param {int* v} a constant and non-negative array of length N
+ * @param {long long C} the capacity
+ * @param {int num_of_threads} the number of threads for merging long lists
+ * @param {bool upper_bound_pruning} drop points that cannot lead to a better optimum
+ * @param {size_t parallel_merge_size} merges of fewer points are done by one thread
+ * @return {sparse_knapsack_result} the optimum, m[AT(N, C)] of the dense table
+*/
+sparse_knapsack_result sparse_pseudo_polynomial_knapsack(int* w, int* v, long long C, int N, int num_of_threads,
+                                                         bool upper_bound_pruning, size_t parallel_merge_size) {
+    std::vector<int> items = prune_knapsack_items(w, v, C, N);
+    // best value per weight first: the bound below shrinks fastest, and good points are found early
+    std::sort(items.begin(), items.end(), [w, v](int a, int b) {
+        return (long long)v[a] * w[b] > (long long)v[b] * w[a];
+    });
+    const int K = (int)items.size();
+
+    // the best value per weight among items[k, K), as an item index; zero weight counts as infinite
+    std::vector<int> best_ratio(K + 1, -1);
+    for ( int k = K - 1; k >= 0; k-- ) {
+        int i = items[k];
+        int b = best_ratio[k + 1];
+        best_ratio[k] = (b < 0 || (long long)v[i] * w[b] > (long long)v[b] * w[i]) ? i : b;
+    }
+
+    sparse_knapsack_result result = {0, K, 1};
+    std::vector<pareto_point> frontier = {{0, 0}};
+    std::vector<pareto_point> merged;
+    for ( int k = 0; k < K; k++ ) {
+        const int i = items[k];
+        merge_pareto_frontier(frontier, merged, w[i], v[i], C, num_of_threads, parallel_merge_size);
+
+        if ( upper_bound_pruning && k + 1 < K ) {
+            // (W, V) cannot beat the best point if V + (C - W) * v[b] / w[b] < best
+            const long long best = frontier.back().value;
+            const int b = best_ratio[k + 1];
+            size_t kept = 0;
+            for ( const pareto_point& point : frontier ) {
+                if ( w[b] == 0
+                    || (__int128)(best - point.value) * w[b] <= (__int128)(C - point.weight) * v[b] ) {
+                    frontier[kept++] = point;
+                }
+            }
+            frontier.resize(kept);
+        }
+        result.max_frontier_size = std::max(result.max_frontier_size, frontier.size());
+    }
+    result.optimum = frontier.back().value;
+    return result;
+}
+
+/**
+ * @description: sparse version of pseudo polynomial knapsack, merging lists of SPARSE_PARALLEL_MERGE_SIZE points
+ *               and more in parallel
+*/
+sparse_knapsack_result sparse_pseudo_polynomial_knapsack(int* w, int* v, long long C, int N, int num_of_threads,
+                                                         bool upper_bound_pruning) {
+    return sparse_pseudo_polynomial_knapsack(w, v, C, N, num_of_threads, upper_bound_pruning,
+                                             SPARSE_PARALLEL_MERGE_SIZE);
+}
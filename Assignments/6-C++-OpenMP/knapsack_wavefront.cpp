@@ -0,0 +1,93 @@
+#include <vector>
+#include <atomic>
+#include <thread>       // std::this_thread::yield
+#include <algorithm>    // std::min
+#include <omp.h>        /* openMP */
+
+/*
+    Temporally blocked wavefront schedule for the pseudo polynomial knapsack.
+
+    openMP_pseudo_polynomial_knapsack opens one parallel region per item, so every row ends in a fork/join
+    barrier and streams the whole previous row from memory. Here the table is cut into blocks of
+    block_of_items rows and tiles of tile_size capacities. A thread computes all rows of a block for one tile
+    before it moves on, so the rows it reads are still in its cache.
+
+    Cell (i, j) depends on (i-1, j) and (i-1, j - w[i-1]), which is in the same tile or in a tile to the
+    left. Tile t of block b can therefore start as soon as
+        - tile t of block b-1 is done, and
+        - tile t-1 of block b is done, which implies that every tile to the left of it is done too.
+    Tiles are dealt out to the threads round robin. Each thread works through its tiles in the order
+    (block, tile), and every wait is for a tile that comes earlier in that order, so the pipeline cannot
+    deadlock. The threads synchronize only through one progress counter per tile: a thread waits on the
+    counter of its left neighbour tile and publishes its own. No global barrier is needed.
+*/
+
+const int WAVEFRONT_TILE_SIZE = 2048;       // capacities per tile, 8 KiB of each row
+const int WAVEFRONT_BLOCK_OF_ITEMS = 32;    // rows computed per tile before moving on
+
+/**
+ * @description: the number of blocks done for one tile, on its own cache line
+ */
+struct alignas(64) tile_progress {
+    std::atomic<int> blocks_done;
+};
+
+
+/**
+ * @description: wavefront version of pseudo polynomial knapsack, without a barrier per item
+ * @param {int* w} a constant and non-negative array of length N
+ * @param {int* v} a constant and non-negative array of length N
+ * @param {int* m} an array of length (C+1)*(N+1) initialized with zeros
+ * @param {int num_of_threads} the number of threads
+ * @param {int tile_size} the number of capacities per tile
+ * @param {int block_of_items} the number of items per block
+*/
+void wavefront_pseudo_polynomial_knapsack(int* w, int* v, int* m, int C, int N, int num_of_threads,
+                                          int tile_size, int block_of_items) {
+
+    const int num_of_tiles = (C + 1 + tile_size - 1) / tile_size;
+    const int num_of_blocks = (N + block_of_items - 1) / block_of_items;
+    std::vector<tile_progress> progress(num_of_tiles);
+    for ( tile_progress& tile : progress ) {
+        tile.blocks_done.store(0, std::memory_order_relaxed);
+    }
+
+    #pragma omp parallel num_threads(num_of_threads)
+    {
+        const int thread_id = omp_get_thread_num();
+        const int team_size = omp_get_num_threads();
+
+        for ( int block = 0; block < num_of_blocks; block++ ) {
+            const int first_item = 1 + block * block_of_items;
+            const int last_item = std::min(N, first_item + block_of_items - 1);
+
+            for ( int tile = thread_id; tile < num_of_tiles; tile += team_size ) {
+                // this thread did tile of block-1 itself; wait for the left neighbour to finish this block
+                if ( tile > 0 ) {
+                    while ( progress[tile - 1].blocks_done.load(std::memory_order_acquire) <= block ) {
+                        std::this_thread::yield();
+                    }
+                }
+
+                const int first_j = tile * tile_size;
+                const int last_j = std::min(C, first_j + tile_size - 1);
+                for ( int i = first_item; i <= last_item; i++ ) {
+                    knapsack_row_kernel(m + AT(i-1, 0), m + AT(i, 0), first_j, last_j, w[i-1], v[i-1]);
+                }
+
+                progress[tile].blocks_done.store(block + 1, std::memory_order_release);
+            }
+        }
+    }
+}
+
+/**
+ * @description: wavefront version of pseudo polynomial knapsack with the default tile and block sizes
+ * @param {int* w} a constant and non-negative array of length N
+ * @param {int* v} a constant and non-negative array of length N
+ * @param {int* m} an array of length (C+1)*(N+1) initialized with zeros
+ * @param {int num_of_threads} the number of threads
+*/
+void wavefront_pseudo_polynomial_knapsack(int* w, int* v, int* m, int C, int N, int num_of_threads) {
+    wavefront_pseudo_polynomial_knapsack(w, v, m, C, N, num_of_threads, WAVEFRONT_TILE_SIZE, WAVEFRONT_BLOCK_OF_ITEMS);
+}
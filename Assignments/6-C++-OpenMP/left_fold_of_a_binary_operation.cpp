@@ -4,6 +4,9 @@
 #include <chrono>       /* time manipulation */
 #include <omp.h>        /* openMP */
 
+#include "monoid_fold.cpp"
+#include "../5-C++-Threads-and-Synchronization/counter_rng.cpp"
+
 /**
  * @description: sequential version of pseudo polynomial knapsack
  * @param {long int* v} a constant and non-negative array of length N
@@ -58,6 +61,74 @@ bool validate_result(long int a, long int b) {
     return true;
 }
 
+/**
+ * @description: fold a large array of zeros and ones, which is far beyond the range of long long
+ * @param {int N} the length of the array
+ */
+void product_tree_left_fold_of_a_large_array(int N) {
+    const unsigned long long p = 1000000007;
+    const int max_num_of_threads = omp_get_max_threads();
+
+    long long int* v = new long long int[N];
+    random_fill_integers(v, N, 0, 2, DEFAULT_RANDOM_SEED + 1, max_num_of_threads);
+    long long int num_of_ones = 0;
+    for ( int i = 0; i < N; i++ ) {
+        num_of_ones += v[i];
+    }
+
+    std::chrono::steady_clock::time_point start_time;
+    std::chrono::duration<double> duration;
+
+    // with v[i] in {0, 1}, the fold from 1 is 2^(number of ones + 1) - 1
+    std::cout << "Running product tree version with N = " << N << ": " << std::endl;
+    start_time = std::chrono::steady_clock::now();
+    big_unsigned result = product_tree_left_fold_of_a_binary_operation(v, N, max_num_of_threads);
+    duration = std::chrono::steady_clock::now() - start_time;
+    std::cout << "number of bits: " << result.bit_length() << std::endl;
+    std::cout << "it takes " << duration.count() << " seconds." << std::endl;
+    std::cout << "validating results: " << std::boolalpha
+              << (result == big_unsigned::all_ones(num_of_ones + 1)) << std::endl;
+    std::cout << "============================================" << std::endl;
+
+    std::cout << "Running modular product tree version with p = " << p << ": " << std::endl;
+    start_time = std::chrono::steady_clock::now();
+    unsigned long long result_modular = modular_left_fold_of_a_binary_operation(v, N, p, max_num_of_threads);
+    duration = std::chrono::steady_clock::now() - start_time;
+    std::cout << result_modular << std::endl;
+    std::cout << "it takes " << duration.count() << " seconds." << std::endl;
+    unsigned long long result_sequential = sequential_modular_left_fold_of_a_binary_operation(v, N, p);
+    std::cout << "validating results: " << std::boolalpha
+              << (result_modular == result_sequential && result_modular == result.mod(p)) << std::endl;
+    std::cout << "============================================" << std::endl;
+
+    delete[] v;
+}
+
+/**
+ * @description: fold arrays of random 32-bit values, so that every limb of the products is dense and the carries
+ *               and borrows of both schoolbook and Karatsuba multiplication are exercised; checked modulo two primes
+ */
+void product_tree_left_fold_of_dense_values() {
+    const unsigned long long primes[] = {1000000007, 998244353};
+    const int max_num_of_threads = omp_get_max_threads();
+    // about one limb per element: below KARATSUBA_THRESHOLD limbs, above it, and above KARATSUBA_TASK_THRESHOLD
+    const int lengths[] = {24, 1 << 8, 1 << 13, 1 << 15};
+
+    for ( int N : lengths ) {
+        long long int* v = new long long int[N];
+        random_fill_integers(v, N, 0, 1LL << 32, DEFAULT_RANDOM_SEED + 2, max_num_of_threads);
+        big_unsigned result = product_tree_left_fold_of_a_binary_operation(v, N, max_num_of_threads);
+        bool correct = true;
+        for ( unsigned long long p : primes ) {
+            correct = correct && result.mod(p) == sequential_modular_left_fold_of_a_binary_operation(v, N, p);
+        }
+        std::cout << "product tree of " << N << " random 32-bit values, " << result.bit_length() << " bits: "
+                  << std::boolalpha << correct << std::endl;
+        delete[] v;
+    }
+    std::cout << "============================================" << std::endl;
+}
+
 
 int main() {
 
@@ -69,10 +140,7 @@ int main() {
     long long int result_openMP = 0;
 
     // initialize matrix w and v
-    srand(time(NULL));  
-    for ( int i = 0; i < N; i++ ) {
-        v[i] = rand() % 2;
-    }
+    random_fill_integers(v, N, 0, 2, DEFAULT_RANDOM_SEED, omp_get_max_threads());
 
     // time manipulation
     std::chrono::steady_clock::time_point start_time;
@@ -102,5 +170,27 @@ int main() {
     // validate result
     validate_result(result, result_openMP);
 
+    // product tree version, exact
+    start_time = std::chrono::steady_clock::now();
+    std::cout << "Running product tree version: " << std::endl;
+    big_unsigned result_product_tree = product_tree_left_fold_of_a_binary_operation(v, N, omp_get_max_threads());
+    end_time = std::chrono::steady_clock::now();
+    duration = end_time - start_time;
+    std::cout << result_product_tree.to_string() << std::endl;
+    std::cout << "it takes " << duration.count() << " seconds." << std::endl;
+    std::cout << "============================================" << std::endl;
+    if ( result_product_tree.bit_length() < 63 ) {
+        validate_result(result, (long int)result_product_tree.to_unsigned_long_long());
+    }
+    else {
+        std::cout << "the long long versions overflow" << std::endl;
+    }
+    std::cout << "============================================" << std::endl;
+
+    delete[] v;
+
+    product_tree_left_fold_of_a_large_array(1 << 22);
+    product_tree_left_fold_of_dense_values();
+
     return 0;
 }
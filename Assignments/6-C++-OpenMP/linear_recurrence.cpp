@@ -0,0 +1,357 @@
+#include <iostream>
+#include <chrono>       /* time manipulation */
+#include <omp.h>        /* openMP */
+#include <array>
+#include <vector>
+#include <string>
+#include <algorithm>    /* std::max */
+#include <cmath>        /* std::fabs */
+#include <cstdint>
+#ifdef __SSE2__
+#include <xmmintrin.h>  /* _mm_getcsr, _mm_setcsr */
+#endif
+
+#include "../5-C++-Threads-and-Synchronization/counter_rng.cpp"
+
+/*
+    Parallel solver for linear recurrences
+        x[i+1] = A[i] * x[i] + b[i]
+    with a state x of K values, so K = 1 is the scalar recurrence x[i+1] = a[i] * x[i] + b[i].
+
+    Every step is an affine map f_i(x) = A[i] x + b[i], and affine maps compose into affine maps:
+        (f_j o f_i)(x) = A[j] A[i] x + (A[j] b[i] + b[j])
+    Composition is associative, so the recurrence is a scan over the maps, done in three phases:
+        1. each thread composes the maps of its chunk into one map,
+        2. one thread applies the chunk maps in order to get the state at the start of every chunk,
+        3. each thread runs its chunk from its start state.
+    Phase 1 multiplies K x K matrices, so it costs about K + 1 times the work of a sequential step,
+    and the speedup over the sequential loop is about p / (K + 2) for p threads.
+
+    The arithmetic is a template parameter: double, or modular<P> for exact integers modulo a prime P.
+    With double the parallel result differs from the sequential one by rounding only, because the products
+    are associated differently.
+
+    The product of many contracting A[i], as in a stable filter, soon falls below the smallest normal double,
+    and arithmetic on denormals is an order of magnitude slower. Phase 1 therefore runs with denormals
+    flushed to zero. That changes the composed maps by less than 1e-308, and the sequential loop and
+    phase 3 are not affected.
+*/
+
+/**
+ * @description: integer modulo a prime P below 2^32
+ */
+template <uint32_t P>
+struct modular {
+    uint32_t value;
+
+    modular() : value(0) {}
+    modular(long long x) : value((uint32_t)(((x % (long long)P) + P) % P)) {}
+
+    friend modular operator+(modular a, modular b) {
+        modular result;
+        result.value = (uint32_t)(((uint64_t)a.value + b.value) % P);
+        return result;
+    }
+    friend modular operator*(modular a, modular b) {
+        modular result;
+        result.value = (uint32_t)((uint64_t)a.value * b.value % P);
+        return result;
+    }
+    friend bool operator==(modular a, modular b) {
+        return a.value == b.value;
+    }
+};
+
+template <typename T, size_t K>
+using state = std::array<T, K>;
+
+/**
+ * @description: the affine map x -> A x + b on K values
+ */
+template <typename T, size_t K>
+struct affine_map {
+    T A[K][K];
+    T b[K];
+
+    /**
+     * @description: the identity map
+     */
+    static affine_map identity() {
+        affine_map f;
+        for ( size_t r = 0; r < K; r++ ) {
+            for ( size_t c = 0; c < K; c++ ) {
+                f.A[r][c] = T(r == c ? 1 : 0);
+            }
+            f.b[r] = T(0);
+        }
+        return f;
+    }
+
+    /**
+     * @description: A x + b
+     */
+    state<T, K> operator()(const state<T, K>& x) const {
+        state<T, K> y;
+        for ( size_t r = 0; r < K; r++ ) {
+            T sum = b[r];
+            for ( size_t c = 0; c < K; c++ ) {
+                sum = sum + A[r][c] * x[c];
+            }
+            y[r] = sum;
+        }
+        return y;
+    }
+
+    /**
+     * @description: the map that applies first, then this
+     */
+    affine_map after(const affine_map& first) const {
+        affine_map f;
+        for ( size_t r = 0; r < K; r++ ) {
+            for ( size_t c = 0; c < K; c++ ) {
+                T sum = T(0);
+                for ( size_t m = 0; m < K; m++ ) {
+                    sum = sum + A[r][m] * first.A[m][c];
+                }
+                f.A[r][c] = sum;
+            }
+            T sum = b[r];
+            for ( size_t m = 0; m < K; m++ ) {
+                sum = sum + A[r][m] * first.b[m];
+            }
+            f.b[r] = sum;
+        }
+        return f;
+    }
+};
+
+
+/**
+ * @description: sequential version of the linear recurrence
+ * @param {affine_map* f} the N steps, f[i] maps x[i] to x[i+1]
+ * @param {int N} the number of steps
+ * @param {state x0} the initial state
+ * @param {state* x} receives the N + 1 states x[0] = x0, ..., x[N]
+ */
+template <typename T, size_t K>
+void sequential_linear_recurrence(const affine_map<T, K>* f, int N, const state<T, K>& x0, state<T, K>* x) {
+    x[0] = x0;
+    for ( int i = 0; i < N; i++ ) {
+        x[i + 1] = f[i](x[i]);
+    }
+}
+
+
+/**
+ * @description: openMP version of the linear recurrence, a scan over the composition of affine maps
+ * @param {affine_map* f} the N steps, f[i] maps x[i] to x[i+1]
+ * @param {int N} the number of steps
+ * @param {state x0} the initial state
+ * @param {state* x} receives the N + 1 states x[0] = x0, ..., x[N]
+ * @param {int num_of_threads} the number of threads
+ */
+template <typename T, size_t K>
+void openMP_linear_recurrence(const affine_map<T, K>* f, int N, const state<T, K>& x0, state<T, K>* x, int num_of_threads) {
+    if ( num_of_threads < 2 || N < 2 * num_of_threads ) {
+        sequential_linear_recurrence(f, N, x0, x);
+        return;
+    }
+
+    std::vector<affine_map<T, K>> chunk_maps(num_of_threads);
+    std::vector<state<T, K>> chunk_starts(num_of_threads);
+
+    #pragma omp parallel num_threads(num_of_threads)
+    {
+        // the runtime may give fewer threads than requested, so the chunks follow the actual team size
+        const int num_of_chunks = omp_get_num_threads();
+        const int chunk = omp_get_thread_num();
+        const int start = (int)((long long)N * chunk / num_of_chunks);
+        const int end = (int)((long long)N * (chunk + 1) / num_of_chunks);
+
+        // phase 1: compose the maps of the chunk
+#ifdef __SSE2__
+        const unsigned int csr = _mm_getcsr();
+        _mm_setcsr(csr | 0x8040);   // flush-to-zero and denormals-are-zero
+#endif
+        affine_map<T, K> composed = affine_map<T, K>::identity();
+        for ( int i = start; i < end; i++ ) {
+            composed = f[i].after(composed);
+        }
+        chunk_maps[chunk] = composed;
+#ifdef __SSE2__
+        _mm_setcsr(csr);
+#endif
+        #pragma omp barrier
+
+        // phase 2: carry the state across the chunks
+        #pragma omp single
+        {
+            chunk_starts[0] = x0;
+            for ( int c = 1; c < num_of_chunks; c++ ) {
+                chunk_starts[c] = chunk_maps[c - 1](chunk_starts[c - 1]);
+            }
+        }
+
+        // phase 3: run the chunk from its start state
+        if ( chunk == 0 ) {
+            x[0] = x0;
+        }
+        state<T, K> current = chunk_starts[chunk];
+        for ( int i = start; i < end; i++ ) {
+            current = f[i](current);
+            x[i + 1] = current;
+        }
+    }
+}
+
+
+/**
+ * @description: equal up to rounding, relative to the magnitude of the values
+ */
+inline bool same_value(double a, double b) {
+    return std::fabs(a - b) <= 1e-9 * std::max(1.0, std::fabs(a));
+}
+
+/**
+ * @description: exactly equal
+ */
+template <uint32_t P>
+inline bool same_value(modular<P> a, modular<P> b) {
+    return a == b;
+}
+
+/**
+ * @description: validate the result from the two versions
+ * @return {bool} if the result is correct, return true
+ */
+template <typename T, size_t K>
+bool validate_result(const state<T, K>* a, const state<T, K>* b, int n) {
+    for ( int i = 0; i < n; i++ ) {
+        for ( size_t r = 0; r < K; r++ ) {
+            if ( !same_value(a[i][r], b[i][r]) ) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+/**
+ * @description: time the sequential version and the openMP version with 1, 2, 4, ... threads on the same steps
+ * @param {std::string name} what the recurrence models
+ * @param {std::vector<affine_map> f} the steps
+ * @param {state x0} the initial state
+ */
+template <typename T, size_t K>
+void benchmark_linear_recurrence(const std::string& name, const std::vector<affine_map<T, K>>& f, const state<T, K>& x0) {
+    const int N = (int)f.size();
+    const int max_num_of_threads = omp_get_max_threads();
+    std::vector<state<T, K>> x(N + 1);
+    std::vector<state<T, K>> x_openMP(N + 1);
+
+    std::chrono::steady_clock::time_point start_time;
+    std::chrono::duration<double> duration;
+
+    std::cout << name << ", K = " << K << ", N = " << N << std::endl;
+    start_time = std::chrono::steady_clock::now();
+    sequential_linear_recurrence(f.data(), N, x0, x.data());
+    duration = std::chrono::steady_clock::now() - start_time;
+    const double sequential_time = duration.count();
+    std::cout << "sequential version takes " << sequential_time << " seconds." << std::endl;
+
+    std::vector<int> thread_counts;
+    for ( int p = 1; p < max_num_of_threads; p *= 2 ) {
+        thread_counts.push_back(p);
+    }
+    thread_counts.push_back(max_num_of_threads);
+
+    for ( int p : thread_counts ) {
+        start_time = std::chrono::steady_clock::now();
+        openMP_linear_recurrence(f.data(), N, x0, x_openMP.data(), p);
+        duration = std::chrono::steady_clock::now() - start_time;
+        std::cout << "openMP version with " << p << " threads takes " << duration.count() << " seconds, "
+                  << "speedup " << sequential_time / duration.count() << ", "
+                  << "validating results: " << std::boolalpha << validate_result<T, K>(x.data(), x_openMP.data(), N + 1)
+                  << std::endl;
+    }
+    std::cout << "============================================" << std::endl;
+}
+
+
+/**
+ * @description: the i-th number of the stream of seed, in [low, high)
+ */
+double random_double(uint64_t seed, int i, double low, double high) {
+    return low + (high - low) * random_uniform(seed, i);
+}
+
+
+int main() {
+
+    const int N = 1 << 22;
+    const uint32_t P = 998244353;
+    const uint64_t seed = DEFAULT_RANDOM_SEED;
+
+    // first-order filter with time-varying gain: y[i+1] = a[i] y[i] + (1 - a[i]) u[i]
+    {
+        std::vector<affine_map<double, 1>> f(N);
+        #pragma omp parallel for
+        for ( int i = 0; i < N; i++ ) {
+            double a = random_double(seed, i, 0.9, 1.0);
+            f[i].A[0][0] = a;
+            f[i].b[0] = (1 - a) * random_double(seed + 1, i, -1, 1);
+        }
+        benchmark_linear_recurrence<double, 1>("exponential filter", f, {{0.0}});
+    }
+
+    // compounding modulo P: balance[i+1] = rate[i] balance[i] + deposit[i]
+    {
+        std::vector<affine_map<modular<P>, 1>> f(N);
+        #pragma omp parallel for
+        for ( int i = 0; i < N; i++ ) {
+            f[i].A[0][0] = modular<P>(random_below(seed + 2, i, P));
+            f[i].b[0] = modular<P>(random_below(seed + 3, i, P));
+        }
+        benchmark_linear_recurrence<modular<P>, 1>("compounding modulo 998244353", f, {{modular<P>(1)}});
+    }
+
+    // damped oscillator with a forcing term, state (position, velocity)
+    {
+        const double dt = 1e-3;
+        std::vector<affine_map<double, 2>> f(N);
+        #pragma omp parallel for
+        for ( int i = 0; i < N; i++ ) {
+            double stiffness = random_double(seed + 4, i, 0.5, 1.5);
+            double damping = random_double(seed + 5, i, 0.0, 0.1);
+            f[i].A[0][0] = 1;
+            f[i].A[0][1] = dt;
+            f[i].A[1][0] = -stiffness * dt;
+            f[i].A[1][1] = 1 - damping * dt;
+            f[i].b[0] = 0;
+            f[i].b[1] = random_double(seed + 6, i, -1, 1) * dt;
+        }
+        benchmark_linear_recurrence<double, 2>("damped oscillator", f, {{1.0, 0.0}});
+    }
+
+    // third-order linear recurrence modulo P in companion form, x[i+3] = c0 x[i+2] + c1 x[i+1] + c2 x[i] + d[i]
+    {
+        std::vector<affine_map<modular<P>, 3>> f(N);
+        #pragma omp parallel for
+        for ( int i = 0; i < N; i++ ) {
+            f[i] = affine_map<modular<P>, 3>::identity();
+            f[i].A[0][0] = modular<P>(random_below(seed + 7, i, P));
+            f[i].A[0][1] = modular<P>(random_below(seed + 8, i, P));
+            f[i].A[0][2] = modular<P>(random_below(seed + 9, i, P));
+            f[i].A[1][1] = modular<P>(0);
+            f[i].A[1][0] = modular<P>(1);
+            f[i].A[2][2] = modular<P>(0);
+            f[i].A[2][1] = modular<P>(1);
+            f[i].b[0] = modular<P>(random_below(seed + 10, i, P));
+        }
+        benchmark_linear_recurrence<modular<P>, 3>("third-order recurrence modulo 998244353", f,
+                                                   {{modular<P>(1), modular<P>(1), modular<P>(1)}});
+    }
+
+    return 0;
+}
@@ -0,0 +1,422 @@
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <algorithm>    // std::max, std::min, std::reverse
+#include <utility>      // std::swap
+#include <omp.h>        /* openMP */
+
+/*
+    Parallel left fold of a binary operation that is isomorphic to a monoid.
+
+    A fold init ⊕ v[0] ⊕ v[1] ⊕ ... ⊕ v[N-1] can be evaluated in any bracketing when there is a map phi with
+        phi(x ⊕ y) = phi(x) * phi(y)
+    for an associative * with an identity. For x ⊕ y = x + y + xy, phi(x) = 1 + x and * is multiplication, so
+        fold = (1 + init) * (1 + v[0]) * ... * (1 + v[N-1]) - 1
+    The product is evaluated as a balanced tree of openMP tasks, so the operands at each level have about the
+    same size. The leaves are small and use schoolbook multiplication. The few large products at the top of the
+    tree use Karatsuba, and the three sub-products of a large Karatsuba step run as tasks too.
+
+    A Monoid is any type with
+        typedef ... value_type;
+        value_type identity() const                                         phi of the neutral element
+        value_type lift(long long x) const                                  phi(x)
+        value_type combine(const value_type& a, const value_type& b) const  associative, a covers lower indices
+*/
+
+const int FOLD_LEAF_SIZE = 64;              // elements folded sequentially at a leaf of the product tree
+const int KARATSUBA_THRESHOLD = 32;         // limbs below which schoolbook multiplication is faster
+const int KARATSUBA_TASK_THRESHOLD = 2048;  // limbs above which the Karatsuba sub-products run as tasks
+
+
+/**
+ * @description: arbitrary-precision unsigned integer, base 2^32 limbs with the least significant first
+ */
+class big_unsigned {
+
+public:
+
+    big_unsigned() {}
+
+    explicit big_unsigned(unsigned long long value) {
+        while ( value > 0 ) {
+            limbs.push_back((uint32_t)value);
+            value >>= 32;
+        }
+    }
+
+    bool is_zero() const {
+        return limbs.empty();
+    }
+
+    /**
+     * @description: the number of significant bits, 0 for zero
+     */
+    long long bit_length() const {
+        if ( limbs.empty() ) {
+            return 0;
+        }
+        long long bits = 32LL * (long long)(limbs.size() - 1);
+        for ( uint32_t top = limbs.back(); top > 0; top >>= 1 ) {
+            bits++;
+        }
+        return bits;
+    }
+
+    /**
+     * @description: the remainder of the division by modulus, for 1 <= modulus < 2^32
+     */
+    unsigned long long mod(unsigned long long modulus) const {
+        unsigned long long remainder = 0;
+        for ( size_t i = limbs.size(); i-- > 0; ) {
+            remainder = ((remainder << 32) | limbs[i]) % modulus;
+        }
+        return remainder;
+    }
+
+    /**
+     * @description: the value, if it fits in 64 bits
+     */
+    unsigned long long to_unsigned_long_long() const {
+        unsigned long long value = 0;
+        for ( size_t i = std::min(limbs.size(), (size_t)2); i-- > 0; ) {
+            value = (value << 32) | limbs[i];
+        }
+        return value;
+    }
+
+    /**
+     * @description: decimal representation, quadratic in the length, so meant for values of moderate size
+     */
+    std::string to_string() const {
+        if ( limbs.empty() ) {
+            return "0";
+        }
+        std::vector<uint32_t> quotient = limbs;
+        std::string digits;
+        while ( !quotient.empty() ) {
+            // divide by 10^9 and emit the remainder as nine digits
+            unsigned long long remainder = 0;
+            for ( size_t i = quotient.size(); i-- > 0; ) {
+                unsigned long long current = (remainder << 32) | quotient[i];
+                quotient[i] = (uint32_t)(current / 1000000000);
+                remainder = current % 1000000000;
+            }
+            trim(quotient);
+            for ( int d = 0; d < 9 && (remainder > 0 || !quotient.empty()); d++ ) {
+                digits.push_back((char)('0' + remainder % 10));
+                remainder /= 10;
+            }
+        }
+        std::reverse(digits.begin(), digits.end());
+        return digits;
+    }
+
+    /**
+     * @description: this - 1, for a positive value
+     */
+    big_unsigned decrement() const {
+        big_unsigned result = *this;
+        for ( size_t i = 0; i < result.limbs.size(); i++ ) {
+            if ( result.limbs[i]-- != 0 ) {
+                break;
+            }
+        }
+        trim(result.limbs);
+        return result;
+    }
+
+    /**
+     * @description: 2^bits - 1
+     */
+    static big_unsigned all_ones(long long bits) {
+        big_unsigned result;
+        result.limbs.assign((size_t)(bits / 32), 0xFFFFFFFFu);
+        if ( bits % 32 != 0 ) {
+            result.limbs.push_back((1u << (bits % 32)) - 1);
+        }
+        return result;
+    }
+
+    friend bool operator==(const big_unsigned& a, const big_unsigned& b) {
+        return a.limbs == b.limbs;
+    }
+
+    friend bool operator!=(const big_unsigned& a, const big_unsigned& b) {
+        return a.limbs != b.limbs;
+    }
+
+    /**
+     * @description: product, schoolbook for short operands and Karatsuba above KARATSUBA_THRESHOLD limbs
+     */
+    friend big_unsigned operator*(const big_unsigned& a, const big_unsigned& b) {
+        big_unsigned result;
+        if ( a.limbs.empty() || b.limbs.empty() ) {
+            return result;
+        }
+        result.limbs = multiply(a.limbs.data(), a.limbs.size(), b.limbs.data(), b.limbs.size());
+        trim(result.limbs);
+        return result;
+    }
+
+private:
+
+    typedef std::vector<uint32_t> limb_vector;
+
+    /**
+     * @description: drop the most significant zero limbs
+     */
+    static void trim(limb_vector& x) {
+        while ( !x.empty() && x.back() == 0 ) {
+            x.pop_back();
+        }
+    }
+
+    /**
+     * @description: x[offset, ...) += y[0, ny), x is long enough to hold the result
+     */
+    static void add_at(limb_vector& x, size_t offset, const uint32_t* y, size_t ny) {
+        unsigned long long carry = 0;
+        size_t i = 0;
+        for ( ; i < ny; i++ ) {
+            carry += (unsigned long long)x[offset + i] + y[i];
+            x[offset + i] = (uint32_t)carry;
+            carry >>= 32;
+        }
+        for ( ; carry != 0; i++ ) {
+            carry += x[offset + i];
+            x[offset + i] = (uint32_t)carry;
+            carry >>= 32;
+        }
+    }
+
+    /**
+     * @description: x -= y, with x >= y
+     */
+    static void subtract(limb_vector& x, const limb_vector& y) {
+        long long borrow = 0;
+        size_t i = 0;
+        for ( ; i < y.size(); i++ ) {
+            long long difference = (long long)x[i] - y[i] - borrow;
+            borrow = difference < 0;
+            x[i] = (uint32_t)(difference + (borrow << 32));
+        }
+        for ( ; borrow != 0; i++ ) {
+            long long difference = (long long)x[i] - borrow;
+            borrow = difference < 0;
+            x[i] = (uint32_t)(difference + (borrow << 32));
+        }
+    }
+
+    /**
+     * @description: x[0, nx) + y[0, ny)
+     */
+    static limb_vector add(const uint32_t* x, size_t nx, const uint32_t* y, size_t ny) {
+        if ( nx < ny ) {
+            std::swap(x, y);
+            std::swap(nx, ny);
+        }
+        limb_vector sum(x, x + nx);
+        sum.push_back(0);
+        add_at(sum, 0, y, ny);
+        trim(sum);
+        return sum;
+    }
+
+    /**
+     * @description: a[0, na) * b[0, nb), na + nb limbs, possibly with leading zeros
+     */
+    static limb_vector multiply(const uint32_t* a, size_t na, const uint32_t* b, size_t nb) {
+        limb_vector product(na + nb, 0);
+        if ( na == 0 || nb == 0 ) {
+            return product;
+        }
+
+        if ( std::min(na, nb) < (size_t)KARATSUBA_THRESHOLD ) {
+            for ( size_t i = 0; i < na; i++ ) {
+                unsigned long long carry = 0;
+                for ( size_t j = 0; j < nb; j++ ) {
+                    carry += (unsigned long long)a[i] * b[j] + product[i + j];
+                    product[i + j] = (uint32_t)carry;
+                    carry >>= 32;
+                }
+                product[i + nb] = (uint32_t)carry;
+            }
+            return product;
+        }
+
+        // split at half of the longer operand: a = a1 * B^half + a0, b = b1 * B^half + b0
+        const size_t half = std::max(na, nb) / 2;
+        const bool large = std::min(na, nb) >= (size_t)KARATSUBA_TASK_THRESHOLD;
+
+        if ( nb <= half || na <= half ) {
+            // one operand fits in the low half: a * b = (a1 * b) * B^half + a0 * b, with a the longer one
+            if ( na < nb ) {
+                std::swap(a, b);
+                std::swap(na, nb);
+            }
+            limb_vector low;
+            limb_vector high;
+            #pragma omp task shared(low) if(large)
+            low = multiply(a, half, b, nb);
+            high = multiply(a + half, na - half, b, nb);
+            #pragma omp taskwait
+            add_at(product, 0, low.data(), low.size());
+            add_at(product, half, high.data(), high.size());
+            return product;
+        }
+
+        // z0 = a0 * b0, z2 = a1 * b1, z1 = (a0 + a1)(b0 + b1) - z0 - z2
+        limb_vector z0;
+        limb_vector z2;
+        limb_vector z1;
+        #pragma omp task shared(z0) if(large)
+        z0 = multiply(a, half, b, half);
+        #pragma omp task shared(z2) if(large)
+        z2 = multiply(a + half, na - half, b + half, nb - half);
+        {
+            limb_vector a_sum = add(a, half, a + half, na - half);
+            limb_vector b_sum = add(b, half, b + half, nb - half);
+            z1 = multiply(a_sum.data(), a_sum.size(), b_sum.data(), b_sum.size());
+        }
+        #pragma omp taskwait
+        trim(z0);
+        trim(z2);
+        subtract(z1, z0);
+        subtract(z1, z2);
+        trim(z1);
+
+        add_at(product, 0, z0.data(), z0.size());
+        add_at(product, half, z1.data(), z1.size());
+        add_at(product, 2 * half, z2.data(), z2.size());
+        return product;
+    }
+
+    limb_vector limbs;
+};
+
+
+/**
+ * @description: x ⊕ y = x + y + xy over arbitrary-precision integers, phi(x) = 1 + x, non-negative x
+ */
+struct one_plus_product_monoid {
+    typedef big_unsigned value_type;
+
+    value_type identity() const {
+        return big_unsigned(1);
+    }
+    value_type lift(long long x) const {
+        return big_unsigned((unsigned long long)x + 1);
+    }
+    value_type combine(const value_type& a, const value_type& b) const {
+        return a * b;
+    }
+};
+
+/**
+ * @description: x ⊕ y = x + y + xy modulo a prime p < 2^63, phi(x) = 1 + x mod p
+ */
+struct modular_one_plus_product_monoid {
+    typedef unsigned long long value_type;
+
+    unsigned long long modulus;
+
+    value_type identity() const {
+        return 1 % modulus;
+    }
+    value_type lift(long long x) const {
+        return ((unsigned long long)x % modulus + 1) % modulus;
+    }
+    value_type combine(const value_type& a, const value_type& b) const {
+        return (unsigned long long)((unsigned __int128)a * b % modulus);
+    }
+};
+
+
+/**
+ * @description: product of phi(v[start]) ... phi(v[end - 1]) as a balanced tree of openMP tasks
+ */
+template <typename Monoid>
+typename Monoid::value_type product_tree(const long long* v, int start, int end, const Monoid& monoid, int task_depth) {
+    if ( end - start <= FOLD_LEAF_SIZE ) {
+        typename Monoid::value_type result = monoid.identity();
+        for ( int i = start; i < end; i++ ) {
+            result = monoid.combine(result, monoid.lift(v[i]));
+        }
+        return result;
+    }
+    const int middle = start + (end - start) / 2;
+    typename Monoid::value_type left;
+    typename Monoid::value_type right;
+    #pragma omp task shared(left) if(task_depth > 0)
+    left = product_tree(v, start, middle, monoid, task_depth - 1);
+    right = product_tree(v, middle, end, monoid, task_depth - 1);
+    #pragma omp taskwait
+    return monoid.combine(left, right);
+}
+
+/**
+ * @description: phi(init) * phi(v[0]) * ... * phi(v[N-1]) in the monoid, evaluated as a parallel product tree
+ * @param {long long* v} a constant array of length N
+ * @param {int N} the length of array v
+ * @param {long long init} the initial value of the fold
+ * @param {Monoid monoid} the monoid the fold is mapped to
+ * @param {int num_of_threads} the number of threads
+ * @return {Monoid::value_type} phi of the fold
+ */
+template <typename Monoid>
+typename Monoid::value_type monoid_fold(const long long* v, int N, long long init, const Monoid& monoid, int num_of_threads) {
+    // enough tasks at the top of the tree to keep every thread busy while the leaf products are uneven
+    int task_depth = 2;
+    for ( int threads = 1; threads < num_of_threads; threads *= 2 ) {
+        task_depth++;
+    }
+
+    typename Monoid::value_type product;
+    #pragma omp parallel num_threads(num_of_threads)
+    {
+        #pragma omp single
+        product = product_tree(v, 0, N, monoid, task_depth);
+    }
+    return monoid.combine(monoid.lift(init), product);
+}
+
+
+/**
+ * @description: exact left fold of x ⊕ y = x + y + xy, starting from 1, as a parallel big integer product tree
+ * @param {long long int* v} a constant and non-negative array of length N
+ * @param {int N} the length of array v
+ * @param {int num_of_threads} the number of threads
+ * @return {big_unsigned} the fold, without overflow
+ */
+big_unsigned product_tree_left_fold_of_a_binary_operation(long long int* v, int N, int num_of_threads) {
+    return monoid_fold(v, N, 1, one_plus_product_monoid(), num_of_threads).decrement();
+}
+
+/**
+ * @description: left fold of x ⊕ y = x + y + xy modulo p, starting from 1, as a parallel product tree
+ * @param {long long int* v} a constant and non-negative array of length N
+ * @param {int N} the length of array v
+ * @param {unsigned long long p} the modulus, a prime below 2^63
+ * @param {int num_of_threads} the number of threads
+ * @return {unsigned long long} the fold modulo p
+ */
+unsigned long long modular_left_fold_of_a_binary_operation(long long int* v, int N, unsigned long long p, int num_of_threads) {
+    modular_one_plus_product_monoid monoid = {p};
+    return (monoid_fold(v, N, 1, monoid, num_of_threads) + p - 1) % p;
+}
+
+/**
+ * @description: sequential left fold of x ⊕ y = x + y + xy modulo p, starting from 1
+ * @param {long long int* v} a constant and non-negative array of length N
+ * @param {int N} the length of array v
+ * @param {unsigned long long p} the modulus, below 2^63
+ * @return {unsigned long long} the fold modulo p
+ */
+unsigned long long sequential_modular_left_fold_of_a_binary_operation(long long int* v, int N, unsigned long long p) {
+    unsigned long long result = 1 % p;
+    for ( int i = 0; i < N; i++ ) {
+        unsigned long long x = (unsigned long long)v[i] % p;
+        result = (unsigned long long)(((unsigned __int128)result + x + (unsigned __int128)result * x) % p);
+    }
+    return result;
+}
@@ -0,0 +1,232 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>    /* std::min, std::max */
+#include <utility>      /* std::swap */
+#include <stdlib.h>     /* RAND_MAX */
+#include <mpi.h>
+
+#include "smoothing_temporal_blocking.cpp"
+#include "../5-C++-Threads-and-Synchronization/counter_rng.cpp"
+
+/*
+    Repetitive smoothing of a vector split across MPI ranks.
+
+    Rank r owns the block [lo, hi) of the vector and stores it with a halo of h points on each side.
+    Every round exchanges the halos with the neighbouring ranks, and then runs k iterations:
+        1. post MPI_Irecv for both halos and MPI_Isend of the first and last h owned points,
+        2. compute the first iteration on [lo + 2, hi - 2), which only reads owned points,
+        3. wait for the halos and compute the first iteration on the rest,
+        4. run the other k - 1 iterations, each on a region 2 points narrower on each side.
+    The halo is h = 2k points, so that the owned points are exact after k iterations. halo_depth = k = 1 is the
+    plain exchange once per iteration. A larger k exchanges M / k times instead of M times, and recomputes
+    about 2k^2 halo points per round on each side.
+
+    Each point is computed with smoothed_point, the same truncating sum as sequential_vector_repetitive_smoothing,
+    so the result is bit-identical. The first and last two points of the whole vector are never smoothed.
+    Every rank must own at least 2 points, and k is lowered until every rank owns at least 2k points.
+
+    Compile and run with, for example,
+        mpicxx -std=c++14 -O3 -fopenmp mpi_vector_repetitive_smoothing.cpp -o mpi_vector_repetitive_smoothing.exe
+        mpirun -np 4 ./mpi_vector_repetitive_smoothing.exe
+*/
+
+/**
+ * @description: sequential version of repetitive smoothing of a vector
+ * @param {int* v} pre-initialized array of length N
+ * @param {int* s} the smoothed version of v, preinitialized with v
+ * @param {int M} the number of iterations
+*/
+void sequential_vector_repetitive_smoothing(int* v, int* s, int N, int M) {
+    for (int i = 0; i < M; i++){
+        for (int j = 2; j < N - 2; j++) {
+            s[j] = 0;
+            for (int k = -2; k < 3; k++) {
+                s[j] += 0.2 * v[j + k];
+            }
+        }
+        for (int j = 0; j < N; j++) {
+            v[j] = s[j];
+        }
+    }
+}
+
+/**
+ * @description: the block [lo, hi) of a vector of length N owned by a rank
+ */
+void block_of_rank(int N, int rank, int size, int& lo, int& hi) {
+    lo = (int)((long long)N * rank / size);
+    hi = (int)((long long)N * (rank + 1) / size);
+}
+
+/**
+ * @description: one iteration on the global points [first, last), fixed ends included
+ * @param {const int* in} the local buffer, where global point j is at in[j - offset]
+ */
+inline void smooth_range(const int* in, int* out, int offset, int N, int first, int last) {
+    const int first_smoothed = std::max(first, 2) - offset;
+    const int last_smoothed = std::min(last, N - 2) - offset;
+    for ( int j = first; j < std::min(last, 2); j++ ) {
+        out[j - offset] = in[j - offset];
+    }
+    for ( int i = first_smoothed; i < last_smoothed; i++ ) {
+        out[i] = smoothed_point(in, i);
+    }
+    for ( int j = std::max(first, std::max(2, N - 2)); j < last; j++ ) {
+        out[j - offset] = in[j - offset];
+    }
+}
+
+/**
+ * @description: MPI version of repetitive smoothing of a vector, with halo exchange overlapped with computation
+ * @param {std::vector<int>&} block: the points [lo, hi) owned by this rank, smoothed in place
+ * @param {int} N: the length of the whole vector
+ * @param {int} M: the number of iterations
+ * @param {int} halo_depth: the number of iterations per halo exchange
+ * @param {MPI_Comm} comm: the ranks sharing the vector, in the order of their blocks
+ * @return {int} the number of halo exchanges
+*/
+int mpi_vector_repetitive_smoothing(std::vector<int>& block, int N, int M, int halo_depth, MPI_Comm comm) {
+    int rank;
+    int size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    int lo;
+    int hi;
+    block_of_rank(N, rank, size, lo, hi);
+
+    // every rank must own the 2k points its neighbours ask for
+    int smallest_block = (int)((long long)N / size);
+    int depth = std::max(1, std::min(halo_depth, smallest_block / 2));
+    const int halo = 2 * depth;
+    const int left = rank > 0 ? rank - 1 : MPI_PROC_NULL;
+    const int right = rank < size - 1 ? rank + 1 : MPI_PROC_NULL;
+
+    // global point j is at local index j - offset
+    const int offset = lo - halo;
+    std::vector<int> current(hi - lo + 2 * halo, 0);
+    std::vector<int> next(current.size(), 0);
+    std::copy(block.begin(), block.end(), current.begin() + halo);
+
+    int exchanges = 0;
+    for ( int done = 0; done < M; done += depth ) {
+        const int steps = std::min(depth, M - done);
+        // the halo needed for this round
+        const int width = 2 * steps;
+
+        MPI_Request requests[4];
+        MPI_Irecv(current.data() + (lo - width - offset), width, MPI_INT, left, 0, comm, &requests[0]);
+        MPI_Irecv(current.data() + (hi - offset), width, MPI_INT, right, 1, comm, &requests[1]);
+        MPI_Isend(current.data() + (lo - offset), width, MPI_INT, left, 1, comm, &requests[2]);
+        MPI_Isend(current.data() + (hi - width - offset), width, MPI_INT, right, 0, comm, &requests[3]);
+        exchanges++;
+
+        // the first iteration: the points that only read owned points, while the halos are in flight
+        const int first = left == MPI_PROC_NULL ? 0 : lo - width + 2;
+        const int last = right == MPI_PROC_NULL ? N : hi + width - 2;
+        const int inner_first = std::min(hi, lo + 2);
+        const int inner_last = std::max(inner_first, hi - 2);
+        smooth_range(current.data(), next.data(), offset, N, inner_first, inner_last);
+        MPI_Waitall(4, requests, MPI_STATUSES_IGNORE);
+        smooth_range(current.data(), next.data(), offset, N, first, inner_first);
+        smooth_range(current.data(), next.data(), offset, N, inner_last, last);
+        std::swap(current, next);
+
+        // the other iterations, each 2 points narrower on the sides that have a neighbour
+        for ( int t = 2; t <= steps; t++ ) {
+            smooth_range(current.data(), next.data(), offset, N,
+                         left == MPI_PROC_NULL ? 0 : lo - width + 2 * t,
+                         right == MPI_PROC_NULL ? N : hi + width - 2 * t);
+            std::swap(current, next);
+        }
+    }
+
+    std::copy(current.begin() + halo, current.begin() + halo + (hi - lo), block.begin());
+    return exchanges;
+}
+
+/**
+ * @description: validate the result from two smoothing methods
+ * @param {int*} A: vector A
+ * @param {int*} B: vector B
+ * @param {int} size: the size of array
+ * @return {bool} if the result is correct, return true
+ */
+bool validate_result(const int* A, const int* B, int size) {
+
+    std::cout << "validating results: ";
+
+    for ( int i = 0; i < size; i++ ) {
+        if ( A[i] != B[i] ) {
+            std::cout << "false" << std::endl;
+            return false;
+        }
+    }
+
+    std::cout << "true" << std::endl;
+    return true;
+}
+
+
+int main(int argc, char** argv) {
+
+    MPI_Init(&argc, &argv);
+    int rank;
+    int size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    const int N = 1 << 20;
+    const int M = 64;
+
+    // rank 0 initializes the vector and computes the sequential result
+    std::vector<int> v;
+    std::vector<int> s;
+    std::vector<int> original;
+    if ( rank == 0 ) {
+        v.resize(N);
+        random_fill_integers(v.data(), N, 0, RAND_MAX, DEFAULT_RANDOM_SEED, omp_get_max_threads());
+        original = v;
+        s = v;
+        double start_time = MPI_Wtime();
+        sequential_vector_repetitive_smoothing(v.data(), s.data(), N, M);
+        std::cout << "Running sequential version: " << std::endl;
+        std::cout << "it takes " << MPI_Wtime() - start_time << " seconds." << std::endl;
+        std::cout << "============================================" << std::endl;
+    }
+
+    // the blocks of all ranks, for scatter and gather
+    std::vector<int> counts(size);
+    std::vector<int> displacements(size);
+    for ( int r = 0; r < size; r++ ) {
+        int lo;
+        int hi;
+        block_of_rank(N, r, size, lo, hi);
+        counts[r] = hi - lo;
+        displacements[r] = lo;
+    }
+
+    for ( int halo_depth : {1, 4, 16} ) {
+        std::vector<int> block(counts[rank]);
+        MPI_Scatterv(original.data(), counts.data(), displacements.data(), MPI_INT,
+                     block.data(), counts[rank], MPI_INT, 0, MPI_COMM_WORLD);
+
+        MPI_Barrier(MPI_COMM_WORLD);
+        double start_time = MPI_Wtime();
+        int exchanges = mpi_vector_repetitive_smoothing(block, N, M, halo_depth, MPI_COMM_WORLD);
+        MPI_Barrier(MPI_COMM_WORLD);
+        double duration = MPI_Wtime() - start_time;
+
+        std::vector<int> result(rank == 0 ? N : 0);
+        MPI_Gatherv(block.data(), counts[rank], MPI_INT,
+                    result.data(), counts.data(), displacements.data(), MPI_INT, 0, MPI_COMM_WORLD);
+        if ( rank == 0 ) {
+            std::cout << "Running MPI version with " << size << " ranks, " << halo_depth << " iterations per exchange: " << std::endl;
+            std::cout << "it takes " << duration << " seconds, " << exchanges << " halo exchanges." << std::endl;
+            std::cout << "============================================" << std::endl;
+            validate_result(s.data(), result.data(), N);
+        }
+    }
+
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,22 @@
+#include <omp.h>        /* openMP */
+
+#include "../5-C++-Threads-and-Synchronization/cost_model.cpp"
+
+/**
+ * @description: open one empty openMP parallel region with num_of_threads threads
+ */
+void launch_empty_openMP_region(int num_of_threads) {
+    #pragma omp parallel num_threads(num_of_threads)
+    {
+    }
+}
+
+/**
+ * @description: cost model shared by the programs in this folder, with the openMP fork/join cost calibrated
+ * @return {CostModel} a model backed by cost_model.cache in the working directory
+ */
+CostModel openMP_cost_model() {
+    CostModel model("cost_model.cache", omp_get_max_threads());
+    model.calibrate_backend("openmp", launch_empty_openMP_region);
+    return model;
+}
@@ -2,9 +2,19 @@
 #include <chrono>       /* time manipulation */
 #include <omp.h>        /* openMP */
 
+#include "openMP_cost_model.cpp"
+#include "../5-C++-Threads-and-Synchronization/counter_rng.cpp"
+
 #define AT(i, j)    ( (i) * (C+1) + (j) )
 #define MAX(x, y)   ( (x) < (y) ? (y) : (x) )
 
+#include "knapsack_linear_memory.cpp"
+#include "knapsack_row_kernel.cpp"
+#include "knapsack_wavefront.cpp"
+#include "knapsack_sparse.cpp"
+#include "subset_sum.cpp"
+#include "knapsack_queries.cpp"
+
 /**
  * @description: sequential version of pseudo polynomial knapsack
  * @param {int* w} a constant and non-negative array of length N
@@ -30,16 +40,13 @@ void sequential_pseudo_polynomial_knapsack(int* w, int* v, int* m, int C, int N)
  * @param {int* w} a constant and non-negative array of length N
  * @param {int* v} a constant and non-negative array of length N
  * @param {int* m} an array of length (C+1)*(N+1) initialized with zeros
+ * @param {int num_of_threads} the number of threads
 */
-void openMP_pseudo_polynomial_knapsack(int* w, int* v, int* m, int C, int N) {
-
-    // maximum number of threads
-    const int max_num_of_threads = omp_get_max_threads();
-    std::cout<< "number of threads: " << max_num_of_threads << std::endl;
+void openMP_pseudo_polynomial_knapsack(int* w, int* v, int* m, int C, int N, int num_of_threads) {
 
     for ( int i = 1; i < N + 1; i++ ) {
         int j = 0;
-        #pragma omp parallel for private(j) num_threads(max_num_of_threads)
+        #pragma omp parallel for private(j) num_threads(num_of_threads)
         for ( j = 0; j < C + 1; j++ ) {
             if ( w[i-1] <= j ) {
                 m[AT(i, j)] = MAX(m[AT(i-1, j)], m[AT(i-1, j-w[i-1])] + v[i-1]);
@@ -52,6 +59,64 @@ void openMP_pseudo_polynomial_knapsack(int* w, int* v, int* m, int C, int N) {
     
 }
 
+/**
+ * @description: openMP version of pseudo polynomial knapsack, with the maximum number of threads
+ * @param {int* w} a constant and non-negative array of length N
+ * @param {int* v} a constant and non-negative array of length N
+ * @param {int* m} an array of length (C+1)*(N+1) initialized with zeros
+*/
+void openMP_pseudo_polynomial_knapsack(int* w, int* v, int* m, int C, int N) {
+
+    // maximum number of threads
+    const int max_num_of_threads = omp_get_max_threads();
+    std::cout<< "number of threads: " << max_num_of_threads << std::endl;
+
+    openMP_pseudo_polynomial_knapsack(w, v, m, C, N, max_num_of_threads);
+}
+
+/**
+ * @description: calibrate the sequential knapsack row kernel, per table cell, unless it is cached
+ * @param {CostModel&} model: the cost model to calibrate
+ */
+void calibrate_pseudo_polynomial_knapsack(CostModel& model) {
+    const int sample_N = 1 << 4;
+    const int sample_C = 1 << 12;
+    int* w = new int[sample_N];
+    int* v = new int[sample_N];
+    int* m = new int[(sample_C+1)*(sample_N+1)]();
+    for ( int i = 0; i < sample_N; i++ ) {
+        w[i] = (i * 37) % sample_C;
+        v[i] = i + 1;
+    }
+    model.calibrate_kernel("knapsack_row", (double)sample_N * (sample_C + 1), [w, v, m, sample_C, sample_N]() {
+        sequential_pseudo_polynomial_knapsack(w, v, m, sample_C, sample_N);
+    });
+    delete[] w;
+    delete[] v;
+    delete[] m;
+}
+
+/**
+ * @description: pseudo polynomial knapsack, sequential or openMP with the number of threads
+ *               the cost model predicts is fastest for a row of C+1 cells and one parallel region per row
+ * @param {int* w} a constant and non-negative array of length N
+ * @param {int* v} a constant and non-negative array of length N
+ * @param {int* m} an array of length (C+1)*(N+1) initialized with zeros
+ * @param {const CostModel&} model: a cost model calibrated by calibrate_pseudo_polynomial_knapsack
+*/
+void dispatched_pseudo_polynomial_knapsack(int* w, int* v, int* m, int C, int N, const CostModel& model) {
+
+    const int num_of_threads = model.choose_threads("openmp", "knapsack_row", C + 1);
+    std::cout<< "number of threads: " << num_of_threads << std::endl;
+
+    if ( num_of_threads == 1 ) {
+        sequential_pseudo_polynomial_knapsack(w, v, m, C, N);
+    }
+    else {
+        openMP_pseudo_polynomial_knapsack(w, v, m, C, N, num_of_threads);
+    }
+}
+
 /**
  * @description: validate the result from two matrix multiplication method
  * @param {int*} A: matrix A
@@ -74,6 +139,332 @@ bool validate_result(int* A, int* B, int matrix_size) {
     return true;
 }
 
+/**
+ * @description: run the O(C) memory versions and reconstruct the chosen items
+ * @param {int* w} a constant and non-negative array of length N
+ * @param {int* v} a constant and non-negative array of length N
+ * @param {int optimum} the expected optimum, -1 if it is unknown
+ */
+void linear_memory_knapsack(int* w, int* v, int C, int N, int optimum) {
+    std::chrono::steady_clock::time_point start_time;
+    std::chrono::duration<double> duration;
+    const int max_num_of_threads = omp_get_max_threads();
+
+    std::cout << "Running O(C) memory sequential version: " << std::endl;
+    start_time = std::chrono::steady_clock::now();
+    int result = linear_memory_pseudo_polynomial_knapsack(w, v, C, N);
+    duration = std::chrono::steady_clock::now() - start_time;
+    std::cout << "optimum: " << result << std::endl;
+    std::cout << "it takes " << duration.count() << " seconds." << std::endl;
+    std::cout << "============================================" << std::endl;
+
+    std::cout << "Running O(C) memory openMP version: " << std::endl;
+    std::cout<< "number of threads: " << max_num_of_threads << std::endl;
+    start_time = std::chrono::steady_clock::now();
+    int result_openMP = openMP_linear_memory_pseudo_polynomial_knapsack(w, v, C, N, max_num_of_threads);
+    duration = std::chrono::steady_clock::now() - start_time;
+    std::cout << "it takes " << duration.count() << " seconds." << std::endl;
+    std::cout << "============================================" << std::endl;
+
+    std::cout << "Running O(C) memory item reconstruction: " << std::endl;
+    start_time = std::chrono::steady_clock::now();
+    std::vector<int> chosen = linear_memory_pseudo_polynomial_knapsack_items(w, v, C, N, max_num_of_threads);
+    duration = std::chrono::steady_clock::now() - start_time;
+    std::cout << "number of chosen items: " << chosen.size() << std::endl;
+    std::cout << "it takes " << duration.count() << " seconds." << std::endl;
+    std::cout << "============================================" << std::endl;
+
+    std::cout << "validating results: " << std::boolalpha
+              << ((optimum < 0 || result == optimum) && result_openMP == result
+                  && validate_items(w, v, C, chosen, result)) << std::endl;
+}
+
+/**
+ * @description: solve an instance whose items fit, far too large for the full table
+ */
+void linear_memory_knapsack_of_a_large_instance(int N, int C) {
+    int* w = new int[N];
+    int* v = new int[N];
+    random_fill_integers(w, N, 1, 1 + C / 16, DEFAULT_RANDOM_SEED + 1, omp_get_max_threads());
+    random_fill_integers(v, N, 0, 1 << 12, DEFAULT_RANDOM_SEED + 2, omp_get_max_threads());
+    std::cout << "============================================" << std::endl;
+    std::cout << "N = " << N << ", C = " << C << ", the full table would take "
+              << (double)(C+1) * (N+1) * sizeof(int) / (1 << 30) << " GiB" << std::endl;
+    std::cout << "============================================" << std::endl;
+    linear_memory_knapsack(w, v, C, N, -1);
+    delete[] w;
+    delete[] v;
+}
+
+/**
+ * @description: run the sparse version with and without upper bound pruning
+ * @param {int* w} a constant and non-negative array of length N
+ * @param {int* v} a constant and non-negative array of length N
+ * @param {long long optimum} the expected optimum, -1 if it is unknown
+ */
+void sparse_knapsack(int* w, int* v, long long C, int N, long long optimum) {
+    std::chrono::steady_clock::time_point start_time;
+    std::chrono::duration<double> duration;
+    long long results[2];
+
+    for ( int pruning = 0; pruning < 2; pruning++ ) {
+        std::cout << "Running sparse version" << (pruning ? " with upper bound pruning: " : ": ") << std::endl;
+        start_time = std::chrono::steady_clock::now();
+        sparse_knapsack_result result = sparse_pseudo_polynomial_knapsack(w, v, C, N, omp_get_max_threads(), pruning);
+        duration = std::chrono::steady_clock::now() - start_time;
+        std::cout << "optimum: " << result.optimum << ", items kept: " << result.num_of_items_kept
+                  << ", largest frontier: " << result.max_frontier_size << std::endl;
+        std::cout << "it takes " << duration.count() << " seconds." << std::endl;
+        std::cout << "============================================" << std::endl;
+        results[pruning] = result.optimum;
+    }
+
+    std::cout << "validating results: " << std::boolalpha
+              << ((optimum < 0 || results[0] == optimum) && results[1] == results[0]) << std::endl;
+}
+
+/**
+ * @description: run the sparse version with parallel merges of short lists, down to a single point,
+ *               with and without upper bound pruning and with 2 to 4 threads; the Pareto lists must be the ones
+ *               of one thread, so the largest one must have the same size
+ * @param {long long optimum} the expected optimum
+ */
+void sparse_knapsack_parallel_merges(int* w, int* v, long long C, int N, long long optimum) {
+    const size_t parallel_merge_sizes[] = {1, 1 << 10};
+    bool correct = true;
+    for ( int pruning = 0; pruning < 2; pruning++ ) {
+        sparse_knapsack_result expected = sparse_pseudo_polynomial_knapsack(w, v, C, N, 1, pruning);
+        for ( size_t parallel_merge_size : parallel_merge_sizes ) {
+            for ( int num_of_threads = 2; num_of_threads <= 4; num_of_threads++ ) {
+                sparse_knapsack_result result = sparse_pseudo_polynomial_knapsack(w, v, C, N, num_of_threads, pruning,
+                                                                                  parallel_merge_size);
+                correct = correct && result.optimum == optimum
+                          && result.max_frontier_size == expected.max_frontier_size;
+            }
+        }
+    }
+    std::cout << "Running sparse version with parallel merges from 1 and 1024 points, 2 to 4 threads: " << std::endl;
+    std::cout << "validating results: " << std::boolalpha << correct << std::endl;
+}
+
+/**
+ * @description: solve an instance with weights up to RAND_MAX and values correlated with the weights
+ * @param {bool} dense_oracle: also solve it with the O(C) memory version, and check the parallel merges against it
+ */
+void sparse_knapsack_of_a_large_instance(int N, long long C, bool dense_oracle) {
+    int* w = new int[N];
+    int* v = new int[N];
+    random_fill_integers(w, N, 0, C < RAND_MAX ? C : RAND_MAX, DEFAULT_RANDOM_SEED + 3, omp_get_max_threads());
+    random_fill_integers(v, N, 0, 1 << 16, DEFAULT_RANDOM_SEED + 4, omp_get_max_threads());
+    for ( int i = 0; i < N; i++ ) {
+        v[i] += w[i] / 1024;
+    }
+    std::cout << "============================================" << std::endl;
+    std::cout << "N = " << N << ", C = " << C << std::endl;
+    std::cout << "============================================" << std::endl;
+    long long optimum = dense_oracle ? linear_memory_pseudo_polynomial_knapsack(w, v, (int)C, N) : -1;
+    sparse_knapsack(w, v, C, N, optimum);
+    if ( dense_oracle ) {
+        sparse_knapsack_parallel_merges(w, v, C, N, optimum);
+    }
+    delete[] w;
+    delete[] v;
+}
+
+/**
+ * @description: solve the knapsack with v[i] = w[i] as a bitset subset sum
+ * @param {bool} dense_oracle: also solve it with the O(C) memory version, and check the threaded update against it
+ */
+void subset_sum_of_a_large_instance(int N, int C, bool dense_oracle) {
+    int* w = new int[N];
+    random_fill_integers(w, N, 1, 1 + (1 << 12), DEFAULT_RANDOM_SEED + 5, omp_get_max_threads());
+    std::cout << "============================================" << std::endl;
+    std::cout << "N = " << N << ", C = " << C << ", v[i] = w[i]" << std::endl;
+    std::cout << "============================================" << std::endl;
+
+    std::chrono::steady_clock::time_point start_time;
+    std::chrono::duration<double> duration;
+
+    std::cout << "Running bitset subset sum version: " << std::endl;
+    start_time = std::chrono::steady_clock::now();
+    std::vector<uint64_t> reach = subset_sum_reachable(w, C, N, omp_get_max_threads());
+    duration = std::chrono::steady_clock::now() - start_time;
+    long long num_of_reachable = 0;
+    for ( uint64_t word : reach ) {
+        num_of_reachable += __builtin_popcountll(word);
+    }
+    int best = highest_subset_sum(reach);
+    std::cout << "reachable capacities: " << num_of_reachable << ", best weight: " << best << std::endl;
+    std::cout << "it takes " << duration.count() << " seconds." << std::endl;
+    std::cout << "============================================" << std::endl;
+
+    if ( dense_oracle ) {
+        std::vector<int> row = linear_memory_pseudo_polynomial_knapsack_row(w, w, C, N);
+        auto same_as_row = [&row, C](const std::vector<uint64_t>& bits) {
+            if ( highest_subset_sum(bits) != row[C] ) {
+                return false;
+            }
+            for ( int j = 0; j <= C; j++ ) {
+                if ( (row[j] == j) != (bool)((bits[j / 64] >> (j % 64)) & 1) ) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        std::cout << "validating results: " << std::boolalpha << same_as_row(reach) << std::endl;
+
+        // bitsets of a few words are split too, so every item goes through the threaded update
+        const long long parallel_words[] = {1, 16};
+        bool same = true;
+        for ( long long words : parallel_words ) {
+            for ( int num_of_threads = 2; num_of_threads <= 4; num_of_threads++ ) {
+                same = same && same_as_row(subset_sum_reachable(w, C, N, num_of_threads, words));
+            }
+        }
+        std::cout << "Running bitset subset sum version split from 1 and 16 words, 2 to 4 threads: " << std::endl;
+        std::cout << "validating results: " << std::boolalpha << same << std::endl;
+    }
+    delete[] w;
+}
+
+/**
+ * @description: build the query table in two appends and answer a batch of capacities
+ * @param {int* w} a constant and non-negative array of length N
+ * @param {int* v} a constant and non-negative array of length N
+ * @param {int* m} the full table, as the oracle
+ */
+void batched_knapsack_queries(int* w, int* v, int* m, int C, int N) {
+    std::chrono::steady_clock::time_point start_time;
+    std::chrono::duration<double> duration;
+    bool correct = true;
+
+    std::cout << "Running batched query version: " << std::endl;
+    start_time = std::chrono::steady_clock::now();
+    knapsack_query_table table(C, omp_get_max_threads());
+    table.append_items(w, v, N / 2);
+    duration = std::chrono::steady_clock::now() - start_time;
+    std::cout << "building the first " << N / 2 << " items takes " << duration.count() << " seconds." << std::endl;
+    for ( int j = 0; j <= C; j++ ) {
+        correct = correct && table.optimum(j) == m[AT(N / 2, j)];
+    }
+
+    start_time = std::chrono::steady_clock::now();
+    table.append_items(w + N / 2, v + N / 2, N - N / 2);
+    duration = std::chrono::steady_clock::now() - start_time;
+    std::cout << "appending the other " << N - N / 2 << " items takes " << duration.count() << " seconds." << std::endl;
+    std::cout << "the table takes " << table.memory_size() / (1 << 20) << " MiB instead of "
+              << (long long)(C+1) * (N+1) * sizeof(int) / (1 << 20) << " MiB" << std::endl;
+
+    std::vector<int> capacities(1 << 12);
+    random_fill_integers(capacities.data(), capacities.size(), 0, C + 1, DEFAULT_RANDOM_SEED + 6, omp_get_max_threads());
+    start_time = std::chrono::steady_clock::now();
+    std::vector<int> optima = table.optimum_batch(capacities);
+    std::vector<std::vector<int>> chosen = table.items_batch(capacities);
+    duration = std::chrono::steady_clock::now() - start_time;
+    std::cout << "answering " << capacities.size() << " queries with items takes " << duration.count() << " seconds." << std::endl;
+
+    int num_of_non_empty = 0;
+    for ( size_t q = 0; q < capacities.size(); q++ ) {
+        correct = correct && optima[q] == m[AT(N, capacities[q])]
+                          && validate_items(w, v, capacities[q], chosen[q], optima[q]);
+        num_of_non_empty += !chosen[q].empty();
+    }
+    std::cout << "queries with a non-empty item set: " << num_of_non_empty << std::endl;
+    std::cout << "============================================" << std::endl;
+    std::cout << "validating results: " << std::boolalpha << correct << std::endl;
+}
+
+/**
+ * @description: answer batched queries on an instance whose items fit, so that the chosen item sets are
+ *               not empty and both appends set bits in the table
+ */
+void batched_knapsack_queries_of_a_fitting_instance(int N, int C) {
+    int* w = new int[N];
+    int* v = new int[N];
+    int* m = new int[(C+1)*(N+1)];
+    random_fill_integers(w, N, 1, 1 + C / 16, DEFAULT_RANDOM_SEED + 10, omp_get_max_threads());
+    random_fill_integers(v, N, 0, 1 << 12, DEFAULT_RANDOM_SEED + 11, omp_get_max_threads());
+    for ( int i = 0; i < (C+1)*(N+1); i++ ) {
+        m[i] = 0;
+    }
+    sequential_pseudo_polynomial_knapsack(w, v, m, C, N);
+
+    std::cout << "============================================" << std::endl;
+    std::cout << "N = " << N << ", C = " << C << ", weights up to C/16" << std::endl;
+    std::cout << "============================================" << std::endl;
+    batched_knapsack_queries(w, v, m, C, N);
+
+    delete[] w;
+    delete[] v;
+    delete[] m;
+}
+
+/**
+ * @description: run the vectorized and wavefront versions on an instance whose items fit, against the sequential
+ *               table, with tiles and blocks small enough that every thread owns several tiles and cells read from
+ *               the tile to the left
+ */
+void dense_knapsack_of_a_fitting_instance(int N, int C) {
+    int* w = new int[N];
+    int* v = new int[N];
+    int* m = new int[(C+1)*(N+1)];
+    int* m_parallel = new int[(C+1)*(N+1)];
+    random_fill_integers(w, N, 1, 1 + C / 8, DEFAULT_RANDOM_SEED + 8, omp_get_max_threads());
+    random_fill_integers(v, N, 0, 1 << 12, DEFAULT_RANDOM_SEED + 9, omp_get_max_threads());
+    for ( int i = 0; i < (C+1)*(N+1); i++ ) {
+        m[i] = 0;
+    }
+    sequential_pseudo_polynomial_knapsack(w, v, m, C, N);
+    auto same_table = [m, m_parallel, C, N]() {
+        for ( int i = 0; i < (C+1)*(N+1); i++ ) {
+            if ( m_parallel[i] != m[i] ) {
+                return false;
+            }
+        }
+        return true;
+    };
+    auto clear_table = [m_parallel, C, N]() {
+        for ( int i = 0; i < (C+1)*(N+1); i++ ) {
+            m_parallel[i] = 0;
+        }
+    };
+
+    std::cout << "============================================" << std::endl;
+    std::cout << "N = " << N << ", C = " << C << ", weights up to C/8, optimum: " << m[AT(N, C)] << std::endl;
+    std::cout << "============================================" << std::endl;
+
+    bool correct = true;
+    clear_table();
+    vectorized_pseudo_polynomial_knapsack(w, v, m_parallel, C, N);
+    correct = same_table();
+    for ( int num_of_threads = 1; num_of_threads <= 4; num_of_threads++ ) {
+        clear_table();
+        openMP_vectorized_pseudo_polynomial_knapsack(w, v, m_parallel, C, N, num_of_threads);
+        correct = correct && same_table();
+    }
+    std::cout << "Running vectorized sequential and openMP versions with 1 to 4 threads: " << std::endl;
+    std::cout << "validating results: " << std::boolalpha << correct << std::endl;
+
+    // neither tile size divides C + 1, the first block size divides N and the second does not
+    const int tile_sizes[] = {64, 100};
+    const int blocks_of_items[] = {8, 5};
+    correct = true;
+    for ( int num_of_threads = 1; num_of_threads <= 4; num_of_threads++ ) {
+        for ( int k = 0; k < 2; k++ ) {
+            clear_table();
+            wavefront_pseudo_polynomial_knapsack(w, v, m_parallel, C, N, num_of_threads,
+                                                 tile_sizes[k], blocks_of_items[k]);
+            correct = correct && same_table();
+        }
+    }
+    std::cout << "Running wavefront version with 1 to 4 threads: " << std::endl;
+    std::cout << "validating results: " << std::boolalpha << correct << std::endl;
+
+    delete[] w;
+    delete[] v;
+    delete[] m;
+    delete[] m_parallel;
+}
 
 int main() {
 
@@ -87,11 +478,8 @@ int main() {
     int* m_openMP = new int[(C+1)*(N+1)];
 
     // initialize matrix w and v
-    srand(time(NULL));  
-    for ( int i = 0; i < N; i++ ) {
-        w[i] = rand();
-        v[i] = rand();
-    }
+    random_fill_integers(w, N, 0, RAND_MAX, DEFAULT_RANDOM_SEED, omp_get_max_threads());
+    random_fill_integers(v, N, 0, RAND_MAX, DEFAULT_RANDOM_SEED + 7, omp_get_max_threads());
 
     // initialize matrix m and m_openMP
     for ( int i = 0; i < (C+1)*(N+1); i++ ) {
@@ -125,5 +513,88 @@ int main() {
     // validate result
     validate_result(m, m_openMP, (C+1)*(N+1));
 
+    // cost model dispatched version, reusing m_openMP: every row after the first is overwritten
+    CostModel model = openMP_cost_model();
+    calibrate_pseudo_polynomial_knapsack(model);
+    model.save();
+    start_time = std::chrono::steady_clock::now();
+    std::cout << "Running cost model dispatched version: " << std::endl;
+    dispatched_pseudo_polynomial_knapsack(w, v, m_openMP, C, N, model);
+    end_time = std::chrono::steady_clock::now();
+    duration = end_time - start_time; 
+    std::cout << "it takes " << duration.count() << " seconds." << std::endl;
+    std::cout << "============================================" << std::endl;
+    validate_result(m, m_openMP, (C+1)*(N+1));
+
+    // vectorized versions, reusing m_openMP: every row after the first is overwritten
+    const double cells = (double)N * (C + 1);
+    start_time = std::chrono::steady_clock::now();
+    std::cout << "Running vectorized sequential version: " << std::endl;
+    vectorized_pseudo_polynomial_knapsack(w, v, m_openMP, C, N);
+    end_time = std::chrono::steady_clock::now();
+    duration = end_time - start_time;
+    std::cout << "it takes " << duration.count() << " seconds, "
+              << cells / duration.count() / 1e9 << " billion cells per second." << std::endl;
+    std::cout << "============================================" << std::endl;
+    validate_result(m, m_openMP, (C+1)*(N+1));
+
+    start_time = std::chrono::steady_clock::now();
+    std::cout << "Running vectorized openMP version: " << std::endl;
+    std::cout<< "number of threads: " << omp_get_max_threads() << std::endl;
+    openMP_vectorized_pseudo_polynomial_knapsack(w, v, m_openMP, C, N, omp_get_max_threads());
+    end_time = std::chrono::steady_clock::now();
+    duration = end_time - start_time;
+    std::cout << "it takes " << duration.count() << " seconds, "
+              << cells / duration.count() / 1e9 << " billion cells per second." << std::endl;
+    std::cout << "============================================" << std::endl;
+    validate_result(m, m_openMP, (C+1)*(N+1));
+
+    // wavefront version, reusing m_openMP: every row after the first is overwritten
+    start_time = std::chrono::steady_clock::now();
+    std::cout << "Running wavefront version: " << std::endl;
+    std::cout<< "number of threads: " << omp_get_max_threads() << std::endl;
+    wavefront_pseudo_polynomial_knapsack(w, v, m_openMP, C, N, omp_get_max_threads());
+    end_time = std::chrono::steady_clock::now();
+    duration = end_time - start_time;
+    std::cout << "it takes " << duration.count() << " seconds." << std::endl;
+    std::cout << "============================================" << std::endl;
+    validate_result(m, m_openMP, (C+1)*(N+1));
+
+    // O(C) memory versions
+    linear_memory_knapsack(w, v, C, N, m[AT(N, C)]);
+
+    // sparse version, with the dense table as the oracle
+    sparse_knapsack(w, v, C, N, m[AT(N, C)]);
+
+    // batched capacity queries, with the dense table as the oracle
+    batched_knapsack_queries(w, v, m, C, N);
+
+    // row kernel with items that fit, in 32-bit and 64-bit values
+    std::cout << "============================================" << std::endl;
+    benchmark_knapsack_row_kernel<int32_t>(C, 1 << 12);
+    benchmark_knapsack_row_kernel<int64_t>(C, 1 << 12);
+
+    delete[] m;
+    delete[] m_openMP;
+    delete[] w;
+    delete[] v;
+
+    // an instance whose full table would take 8 GiB
+    linear_memory_knapsack_of_a_large_instance(1 << 15, 1 << 16);
+
+    // capacities up to 10^9, with the O(C) memory version as the oracle where it is feasible
+    sparse_knapsack_of_a_large_instance(1 << 15, 1 << 16, true);
+    sparse_knapsack_of_a_large_instance(1 << 15, 1000000000, false);
+
+    // subset sum with many equal weights, with the O(C) memory version as the oracle where it is feasible
+    subset_sum_of_a_large_instance(1 << 12, 1 << 16, true);
+    subset_sum_of_a_large_instance(1 << 20, 1 << 22, false);
+
+    // the vectorized and wavefront versions on items that fit, with small tiles and blocks
+    dense_knapsack_of_a_fitting_instance(1 << 10, 1 << 10);
+
+    // batched capacity queries on items that fit, with the full table as the oracle
+    batched_knapsack_queries_of_a_fitting_instance(1 << 12, 1 << 13);
+
     return 0;
 }
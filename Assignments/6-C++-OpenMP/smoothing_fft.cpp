@@ -0,0 +1,240 @@
+#include <vector>
+#include <cmath>        // std::cos, std::sin, std::pow, std::log2, std::sqrt
+#include <limits>       // std::numeric_limits
+#include <algorithm>    // std::min, std::max, std::copy
+#include <utility>      // std::swap
+#include <omp.h>        /* openMP */
+
+/*
+    Closed form of the repetitive smoothing in double precision, for large M.
+
+    Without truncation, one iteration is a convolution with the kernel K = 0.2 * (1 1 1 1 1), so M iterations
+    are one convolution with K^M, a kernel of 4M + 1 taps. Its spectrum is known in closed form,
+        K^(w) = 0.2 * (1 + 2 cos w + 2 cos 2w),        (K^M)^(w) = K^(w)^M,
+    so the convolution takes one forward and one inverse FFT of length L, the next power of two >= N,
+    whatever M is.
+
+    The ends of the vector are never smoothed, which breaks the convolution near them. A point j depends on
+    [j - 2M, j + 2M] of the input, and on fixed ends only if that range, shrunk by 2 per iteration, reaches
+    them. So the points [2M, N - 2M) are exactly the convolution, and the FFT does not even wrap around for
+    them. The 2M points at each end are computed by iterating the direct stencil on the 4M points next to
+    the end, which costs O(M^2) and does not depend on N.
+
+    Error bound. Let eps be the unit roundoff (2^-53), x the input, and y the iterative double precision
+    result. The iterative path makes an error of at most 5 eps ||x||_inf per iteration, since every point is
+    a positive average of at most ||x||_inf. The FFT convolution has an error of at most about
+    10 log2(L) eps ||x||_2 for the two transforms. The spectrum raised to the M-th power adds M eps ||x||_2,
+    because |K^(w)| <= 1. Together:
+        max_j |y_fft[j] - y[j]| <= eps * ((10 log2(L) + M) * ||x||_2 + 5 M ||x||_inf)
+    smoothing_fft_error_bound computes it. In practice, the error is two to three orders of magnitude smaller.
+*/
+
+/**
+ * @description: double precision version of repetitive smoothing of a vector, without truncation
+ * @param {double* v} pre-initialized array of length N
+ * @param {double* s} the smoothed version of v, preinitialized with v
+ * @param {int M} the number of iterations
+*/
+void double_vector_repetitive_smoothing(double* v, double* s, int N, int M) {
+    for (int i = 0; i < M; i++){
+        for (int j = 2; j < N - 2; j++) {
+            s[j] = 0;
+            for (int k = -2; k < 3; k++) {
+                s[j] += 0.2 * v[j + k];
+            }
+        }
+        for (int j = 0; j < N; j++) {
+            v[j] = s[j];
+        }
+    }
+}
+
+/**
+ * @description: in place radix-2 FFT of (re, im), of a power-of-two length, inside an enclosing parallel region
+ * @param {const double* cosines, sines} the twiddles exp(-2 pi i k / L) for k < L / 2
+ * @param {bool} inverse: conjugate twiddles, without the 1 / L scaling
+ */
+void fft_in_parallel_region(double* re, double* im, const double* cosines, const double* sines, int L, bool inverse) {
+    int log_L = 0;
+    while ( (1 << log_L) < L ) {
+        log_L++;
+    }
+
+    #pragma omp for schedule(static)
+    for ( int i = 0; i < L; i++ ) {
+        int j = 0;
+        for ( int b = 0; b < log_L; b++ ) {
+            j |= ((i >> b) & 1) << (log_L - 1 - b);
+        }
+        if ( i < j ) {
+            std::swap(re[i], re[j]);
+            std::swap(im[i], im[j]);
+        }
+    }
+
+    const double sign = inverse ? -1 : 1;
+    for ( int half = 1; half < L; half *= 2 ) {
+        const int step = L / (2 * half);
+        // the implicit barrier of the omp for ends the stage
+        #pragma omp for schedule(static)
+        for ( int k = 0; k < L / 2; k++ ) {
+            const int position = k % half;
+            const int i = (k / half) * 2 * half + position;
+            const int j = i + half;
+            const double wr = cosines[position * step];
+            const double wi = sign * sines[position * step];
+            const double tr = re[j] * wr - im[j] * wi;
+            const double ti = re[j] * wi + im[j] * wr;
+            re[j] = re[i] - tr;
+            im[j] = im[i] - ti;
+            re[i] += tr;
+            im[i] += ti;
+        }
+    }
+}
+
+/**
+ * @description: the error bound of the FFT mode against double_vector_repetitive_smoothing
+ * @param {const double* x} the input of length N
+ * @return {double} eps * ((10 log2(L) + M) * ||x||_2 + 5 M ||x||_inf)
+ */
+double smoothing_fft_error_bound(const double* x, int N, int M) {
+    int L = 1;
+    while ( L < N ) {
+        L *= 2;
+    }
+    double norm_2 = 0;
+    double norm_inf = 0;
+    for ( int j = 0; j < N; j++ ) {
+        norm_2 += x[j] * x[j];
+        norm_inf = std::max(norm_inf, std::abs(x[j]));
+    }
+    const double eps = std::numeric_limits<double>::epsilon() / 2;
+    return eps * ((10 * std::log2((double)L) + M) * std::sqrt(norm_2) + 5.0 * M * norm_inf);
+}
+
+/**
+ * @description: the iterative result on the points [a, b), from the input window [a - 2M, b + 2M)
+ * @param {const double* x} the input of length N
+ * @param {double* y} the output, only [a, b) is written
+ */
+void smoothing_window(const double* x, double* y, int N, int M, int a, int b) {
+    const int g0 = std::max(0, a - 2 * M);
+    const int g1 = std::min(N, b + 2 * M);
+    std::vector<double> current(x + g0, x + g1);
+    std::vector<double> next(current);
+    // after iteration t, [g0 + 2t, g1 - 2t) is exact, and the ends of the vector always are
+    for ( int t = 1; t <= M; t++ ) {
+        const int first = std::max(2, g0 == 0 ? 0 : g0 + 2 * t);
+        const int last = std::min(N - 2, g1 == N ? N : g1 - 2 * t);
+        for ( int j = first; j < last; j++ ) {
+            double sum = 0;
+            for ( int k = -2; k < 3; k++ ) {
+                sum += 0.2 * current[j + k - g0];
+            }
+            next[j - g0] = sum;
+        }
+        std::swap(current, next);
+    }
+    std::copy(current.begin() + (a - g0), current.begin() + (b - g0), y + a);
+}
+
+/**
+ * @description: FFT version of double precision repetitive smoothing, O(N log N + M^2)
+ * @param {double* v} pre-initialized array of length N
+ * @param {double* s} the smoothed version of v, preinitialized with v; both v and s hold the result
+ * @param {int M} the number of iterations
+ * @param {int num_of_threads} the number of threads
+*/
+void fft_vector_repetitive_smoothing(double* v, double* s, int N, int M, int num_of_threads) {
+    if ( M <= 0 ) {
+        return;
+    }
+    // with 4M >= N, every point is near an end
+    const int middle_first = std::min(N, 2 * M);
+    const int middle_last = std::max(middle_first, N - 2 * M);
+
+    int L = 1;
+    while ( L < N ) {
+        L *= 2;
+    }
+    std::vector<double> re(L, 0);
+    std::vector<double> im(L, 0);
+    std::vector<double> cosines(L / 2 + 1);
+    std::vector<double> sines(L / 2 + 1);
+    const double pi = std::acos(-1.0);
+
+    if ( middle_first < middle_last ) {
+        #pragma omp parallel num_threads(num_of_threads)
+        {
+            #pragma omp for schedule(static)
+            for ( int k = 0; k < L / 2; k++ ) {
+                cosines[k] = std::cos(2 * pi * k / L);
+                sines[k] = -std::sin(2 * pi * k / L);
+            }
+            #pragma omp for schedule(static)
+            for ( int j = 0; j < N; j++ ) {
+                re[j] = v[j];
+            }
+
+            fft_in_parallel_region(re.data(), im.data(), cosines.data(), sines.data(), L, false);
+
+            // multiply by the spectrum of K^M, and by 1 / L for the inverse transform
+            #pragma omp for schedule(static)
+            for ( int k = 0; k < L; k++ ) {
+                const double w = 2 * pi * k / L;
+                const double gain = std::pow(0.2 * (1 + 2 * std::cos(w) + 2 * std::cos(2 * w)), M) / L;
+                re[k] *= gain;
+                im[k] *= gain;
+            }
+
+            fft_in_parallel_region(re.data(), im.data(), cosines.data(), sines.data(), L, true);
+        }
+    }
+
+    // the ends, from the input, before v is overwritten
+    std::vector<double> result(N);
+    smoothing_window(v, result.data(), N, M, 0, middle_first);
+    smoothing_window(v, result.data(), N, M, middle_last, N);
+    std::copy(re.begin() + middle_first, re.begin() + middle_last, result.begin() + middle_first);
+
+    #pragma omp parallel for num_threads(num_of_threads)
+    for ( int j = 0; j < N; j++ ) {
+        v[j] = result[j];
+        s[j] = result[j];
+    }
+}
+
+/**
+ * @description: whether the FFT version is cheaper than M direct iterations
+ *               direct: about 6 flops per point and iteration;
+ *               FFT: about 10 flops per point and stage for two transforms, plus the ends, 2 * (4M)^2 points
+ */
+bool smoothing_prefers_fft(int N, int M) {
+    if ( 4LL * M >= N ) {
+        return false;
+    }
+    int log_L = 0;
+    while ( (1LL << log_L) < N ) {
+        log_L++;
+    }
+    const double direct = 6.0 * N * M;
+    const double fft = 10.0 * (1LL << log_L) * log_L + 6.0 * 8.0 * M * M;
+    return fft < direct;
+}
+
+/**
+ * @description: double precision repetitive smoothing, with the direct stencil or the FFT, whichever is cheaper
+ * @param {double* v} pre-initialized array of length N
+ * @param {double* s} the smoothed version of v, preinitialized with v; both v and s hold the result
+ * @param {int M} the number of iterations
+ * @param {int num_of_threads} the number of threads
+*/
+void dispatched_double_vector_repetitive_smoothing(double* v, double* s, int N, int M, int num_of_threads) {
+    if ( smoothing_prefers_fft(N, M) ) {
+        fft_vector_repetitive_smoothing(v, s, N, M, num_of_threads);
+    }
+    else {
+        stencil_iterate<vector_smoothing_stencil>(v, s, {1, 1, N}, M, num_of_threads);
+    }
+}
@@ -0,0 +1,118 @@
+#include <algorithm>    // std::min, std::max, std::copy
+#include <utility>      // std::swap
+#include <omp.h>        /* openMP */
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>  // AVX2 and AVX-512 intrinsics
+#endif
+
+/*
+    Double buffered smoothing in one parallel region.
+
+    openMP_vector_repetitive_smoothing opens two parallel regions per iteration and copies s back into v.
+    Here v and s take turns as input and output: every thread swaps its own copy of the two pointers, and
+    each iteration ends with one barrier. The result is copied into the other buffer once, at the end.
+
+    There are two kernels for a row of points:
+        - exact: the truncating sum of the plain versions, s = (int)(s + 0.2 * v[j + k]) for each k, with
+          the same expression (smoothed_point), so the compiler vectorizes and contracts it the same way.
+          The results are bit-identical.
+        - fast: (int)(0.2 * (v[j-2] + ... + v[j+2])), one multiply and one truncation per point. The five
+          ints are added as doubles, which is exact. It runs on 8 lanes with AVX-512 or 4 lanes with AVX2,
+          with unaligned loads shifted by -2 ... 2. The results can differ from the exact kernel by a small
+          amount per iteration, because the exact kernel truncates every term.
+*/
+
+/**
+ * @description: fast smoothing of the points [j, last_j) with vector instructions, returns the first j it did not process
+ */
+inline int smoothing_window_sum(const int* in, int* out, int j, int last_j) {
+#ifdef __AVX512F__
+    const __m512d fifth_512 = _mm512_set1_pd(0.2);
+    for ( ; j + 8 <= last_j; j += 8 ) {
+        __m512d sum = _mm512_cvtepi32_pd(_mm256_loadu_si256((const __m256i*)(in + j - 2)));
+        for ( int k = -1; k < 3; k++ ) {
+            sum = _mm512_add_pd(sum, _mm512_cvtepi32_pd(_mm256_loadu_si256((const __m256i*)(in + j + k))));
+        }
+        _mm256_storeu_si256((__m256i*)(out + j), _mm512_cvttpd_epi32(_mm512_mul_pd(sum, fifth_512)));
+    }
+#endif
+#ifdef __AVX2__
+    const __m256d fifth_256 = _mm256_set1_pd(0.2);
+    for ( ; j + 4 <= last_j; j += 4 ) {
+        __m256d sum = _mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i*)(in + j - 2)));
+        for ( int k = -1; k < 3; k++ ) {
+            sum = _mm256_add_pd(sum, _mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i*)(in + j + k))));
+        }
+        _mm_storeu_si128((__m128i*)(out + j), _mm256_cvttpd_epi32(_mm256_mul_pd(sum, fifth_256)));
+    }
+#endif
+    return j;
+}
+
+/**
+ * @description: smooth the points [first_j, last_j) of in into out
+ * @param {const int*} in: the vector before the iteration
+ * @param {int*} out: the vector after the iteration, must not overlap in
+ * @param {bool} exact: truncate every term as the plain versions do
+ */
+inline void smoothing_stencil_kernel(const int* in, int* out, int first_j, int last_j, bool exact) {
+    int j = first_j;
+    if ( exact ) {
+        for ( ; j < last_j; j++ ) {
+            out[j] = smoothed_point(in, j);
+        }
+        return;
+    }
+    j = smoothing_window_sum(in, out, j, last_j);
+    for ( ; j < last_j; j++ ) {
+        long long sum = (long long)in[j-2] + in[j-1] + in[j] + in[j+1] + in[j+2];
+        out[j] = 0.2 * sum;
+    }
+}
+
+/**
+ * @description: double buffered version of repetitive smoothing of a vector, one parallel region for all iterations
+ * @param {int* v} pre-initialized array of length N
+ * @param {int* s} the smoothed version of v, preinitialized with v
+ * @param {int M} the number of iterations
+ * @param {int num_of_threads} the number of threads
+ * @param {bool exact} bit-identical to the plain versions, otherwise the fast kernel
+*/
+void double_buffered_vector_repetitive_smoothing(int* v, int* s, int N, int M, int num_of_threads, bool exact) {
+    if ( M <= 0 ) {
+        return;
+    }
+
+    #pragma omp parallel num_threads(num_of_threads)
+    {
+        const int thread_id = omp_get_thread_num();
+        const int team_size = omp_get_num_threads();
+        // slices of the smoothed points [2, N-2), a whole number of cache lines long
+        const int points = std::max(0, N - 4);
+        const int slice = ((points + team_size - 1) / team_size + 15) / 16 * 16;
+        const int first_j = 2 + std::min(points, thread_id * slice);
+        const int last_j = 2 + std::min(points, (thread_id + 1) * slice);
+
+        int* in = v;
+        int* out = s;
+        for ( int i = 0; i < M; i++ ) {
+            // the first iteration copies the ends of s into v, and v is read again from the third iteration on
+            if ( i == 1 && thread_id == 0 ) {
+                for ( int j = 0; j < std::min(N, 2); j++ ) {
+                    v[j] = s[j];
+                }
+                for ( int j = std::max(2, N - 2); j < N; j++ ) {
+                    v[j] = s[j];
+                }
+            }
+            smoothing_stencil_kernel(in, out, first_j, last_j, exact);
+            std::swap(in, out);
+            #pragma omp barrier
+        }
+
+        // the result is in the last output; copy it into the other buffer, ends included
+        const int copy_first = (int)((long long)N * thread_id / team_size);
+        const int copy_last = (int)((long long)N * (thread_id + 1) / team_size);
+        std::copy(in + copy_first, in + copy_last, out + copy_first);
+    }
+}
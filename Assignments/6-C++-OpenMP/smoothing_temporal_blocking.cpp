@@ -0,0 +1,120 @@
+#include <vector>
+#include <algorithm>    // std::min, std::max, std::copy
+#include <utility>      // std::swap
+#include <omp.h>        /* openMP */
+
+/*
+    Temporally blocked repetitive smoothing, with overlapped tiles.
+
+    The plain versions make two passes over the whole vector per iteration: one computes s, the other copies it
+    back into v. Here every thread owns a contiguous chunk of the vector and cuts it into tiles of tile_size
+    points. For a tile [a, b), the thread loads [a - 2M, b + 2M) into a private buffer and applies all M
+    iterations there. Each iteration shrinks the part of the buffer that is still exact by 2 points on each
+    side, so [a, b) is exact after M iterations. The buffer stays in cache, and the vector is read and written
+    about once instead of 2M times. The halos are computed more than once, an overhead of about 4M / tile_size.
+
+    Each point is computed with the same operations in the same order as the plain versions. In particular
+    every term truncates to int on its own, so the results are bit-identical.
+
+    Tiles overwrite v and s in place. The original values that a tile still needs after its left neighbour was
+    written are carried over in a small buffer. The values that belong to a neighbouring thread are saved
+    before a barrier.
+*/
+
+const int SMOOTHING_TILE_SIZE = 1 << 13;    // points per tile, 32 KiB of ints
+
+/**
+ * @description: one smoothed point, the same truncating sum as the plain versions
+ */
+inline int smoothed_point(const int* v, int j) {
+    int s = 0;
+    for ( int k = -2; k < 3; k++ ) {
+        s += 0.2 * v[j + k];
+    }
+    return s;
+}
+
+/**
+ * @description: temporally blocked version of repetitive smoothing of a vector
+ * @param {int* v} pre-initialized array of length N
+ * @param {int* s} the smoothed version of v, preinitialized with v
+ * @param {int M} the number of iterations
+ * @param {int num_of_threads} the number of threads
+ * @param {int tile_size} the number of points per tile
+*/
+void temporally_blocked_vector_repetitive_smoothing(int* v, int* s, int N, int M, int num_of_threads, int tile_size) {
+    if ( M <= 0 ) {
+        return;
+    }
+    const int halo = 2 * M;
+    // the ends are never smoothed, so every iteration copies them from s
+    const std::vector<int> head(s, s + std::min(N, 2));
+    const std::vector<int> tail(s + std::max(0, N - 2), s + N);
+
+    #pragma omp parallel num_threads(num_of_threads)
+    {
+        const int thread_id = omp_get_thread_num();
+        const int team_size = omp_get_num_threads();
+        const int lo = (int)((long long)N * thread_id / team_size);
+        const int hi = (int)((long long)N * (thread_id + 1) / team_size);
+
+        // the original values on both sides of this chunk, before the neighbours overwrite them
+        const int right_end = std::min(N, hi + halo);
+        std::vector<int> carry(v + std::max(0, lo - halo), v + lo);
+        std::vector<int> right_halo(v + hi, v + right_end);
+        #pragma omp barrier
+
+        std::vector<int> buffer;
+        std::vector<int> next;
+        for ( int a = lo; a < hi; a += tile_size ) {
+            const int b = std::min(hi, a + tile_size);
+            const int g0 = std::max(0, a - halo);
+            const int g1 = std::min(N, b + halo);
+
+            // buffer[x] holds point g0 + x: carried values, then this chunk, then the right halo
+            buffer.resize(g1 - g0);
+            next.resize(g1 - g0);
+            std::copy(carry.end() - (a - g0), carry.end(), buffer.begin());
+            std::copy(v + a, v + std::min(g1, hi), buffer.begin() + (a - g0));
+            if ( g1 > hi ) {
+                std::copy(right_halo.begin(), right_halo.begin() + (g1 - hi), buffer.begin() + (hi - g0));
+            }
+            const int carry_begin = std::max(g0, b - halo);
+            carry.assign(buffer.begin() + (carry_begin - g0), buffer.begin() + (b - g0));
+
+            // after iteration t, the points [g0 + 2t, g1 - 2t) are exact, and the ends of the vector always are
+            for ( int t = 1; t <= M; t++ ) {
+                const int first = g0 == 0 ? 0 : g0 + 2 * t;
+                const int last = g1 == N ? N : g1 - 2 * t;
+                const int first_smoothed = std::max(first, 2);
+                const int last_smoothed = std::min(last, N - 2);
+                const int* in = buffer.data() - g0;
+                int* out = next.data() - g0;
+                for ( int j = first; j < std::min(last, 2); j++ ) {
+                    out[j] = head[j];
+                }
+                for ( int j = first_smoothed; j < last_smoothed; j++ ) {
+                    out[j] = smoothed_point(in, j);
+                }
+                for ( int j = std::max(first, std::max(2, N - 2)); j < last; j++ ) {
+                    out[j] = tail[j - (N - 2)];
+                }
+                std::swap(buffer, next);
+            }
+
+            std::copy(buffer.begin() + (a - g0), buffer.begin() + (b - g0), v + a);
+            std::copy(buffer.begin() + (a - g0), buffer.begin() + (b - g0), s + a);
+        }
+    }
+}
+
+/**
+ * @description: temporally blocked version of repetitive smoothing of a vector with the default tile size
+ * @param {int* v} pre-initialized array of length N
+ * @param {int* s} the smoothed version of v, preinitialized with v
+ * @param {int M} the number of iterations
+ * @param {int num_of_threads} the number of threads
+*/
+void temporally_blocked_vector_repetitive_smoothing(int* v, int* s, int N, int M, int num_of_threads) {
+    temporally_blocked_vector_repetitive_smoothing(v, s, N, M, num_of_threads, SMOOTHING_TILE_SIZE);
+}
@@ -0,0 +1,250 @@
+#include <array>
+#include <algorithm>    // std::min, std::max, std::copy
+#include <utility>      // std::swap
+#include <type_traits>  // std::integral_constant
+#include <omp.h>        /* openMP */
+
+/*
+    Stencil engine for 1D, 2D and 3D grids.
+
+    A stencil is a compile-time type, stencil<D, R, Weights, boundary>:
+        - D is the number of dimensions, 1, 2 or 3,
+        - R is the radius, so every point reads a (2R+1)^D neighbourhood,
+        - Weights::at(dz, dy, dx) is a constexpr function with the weight of each offset,
+        - boundary says what happens to the points within R of an edge:
+            skip:     they keep their value,
+            clamp:    reads outside the grid take the nearest point on the edge,
+            periodic: reads outside the grid wrap around.
+    The offsets are expanded by template recursion, so every instance gets a fully unrolled kernel with its
+    weights as constants, and offsets of weight 0 are left out.
+
+    A point is computed as
+        T acc = 0;
+        acc += Weights::at(dz, dy, dx) * in[z + dz, y + dy, x + dx];        for dz, dy, dx in increasing order
+    in the element type T. With T = int, every term truncates to int, exactly like the repetitive smoothing,
+    so vector_repetitive_smoothing is the instance stencil<1, 2, smoothing_weights, skip>.
+
+    The grid is stored row-major with x fastest, and a 1D or 2D grid has nz = 1 (and ny = 1). One parallel
+    region runs all iterations, with two buffers taking turns as input and output. In each iteration, the
+    grid is cut into blocks of block_z * block_y rows of block_x points, which the threads share through
+    an omp for; the implicit barrier of the omp for ends the iteration. A block reads its rows, plus R rows
+    on each side, while they are still in cache from its neighbours.
+*/
+
+enum class stencil_boundary { skip, clamp, periodic };
+
+const int STENCIL_BLOCK_Z = 8;
+const int STENCIL_BLOCK_Y = 16;
+const int STENCIL_BLOCK_X = 2048;
+
+/**
+ * @description: calls f(std::integral_constant<int, I>()) for I in [Begin, End), unrolled at compile time
+ */
+template <int Begin, int End>
+struct unrolled_for {
+    template <typename F>
+    static inline void run(F& f) {
+        f(std::integral_constant<int, Begin>());
+        unrolled_for<Begin + 1, End>::run(f);
+    }
+};
+
+template <int End>
+struct unrolled_for<End, End> {
+    template <typename F>
+    static inline void run(F&) {}
+};
+
+/**
+ * @description: the weights of the repetitive smoothing, 0.2 for each of the 5 points
+ */
+struct smoothing_weights {
+    static constexpr double at(int, int, int) { return 0.2; }
+};
+
+
+template <int D, int R, typename Weights, stencil_boundary Boundary>
+struct stencil {
+    static_assert(D >= 1 && D <= 3, "a stencil has 1, 2 or 3 dimensions");
+    static_assert(R >= 1, "the radius is at least 1");
+
+    static constexpr int dimensions = D;
+    static constexpr int radius = R;
+    static constexpr int width = 2 * R + 1;
+    static constexpr int num_of_offsets = D == 1 ? width : D == 2 ? width * width : width * width * width;
+
+    // offset o of the neighbourhood, with x fastest
+    static constexpr int dx(int o) { return o % width - R; }
+    static constexpr int dy(int o) { return D >= 2 ? (o / width) % width - R : 0; }
+    static constexpr int dz(int o) { return D >= 3 ? o / (width * width) - R : 0; }
+
+    /**
+     * @description: index i along a dimension of n points, moved inside the grid by the boundary policy
+     */
+    static inline int boundary_index(int i, int n) {
+        if ( Boundary == stencil_boundary::clamp ) {
+            return std::min(n - 1, std::max(0, i));
+        }
+        return ((i % n) + n) % n;
+    }
+
+    /**
+     * @description: a point whose whole neighbourhood is inside the grid
+     */
+    template <typename T>
+    static inline T interior_point(const T* p, long long stride_z, long long stride_y) {
+        T acc = 0;
+        auto term = [&](auto offset) {
+            constexpr int o = decltype(offset)::value;
+            constexpr double weight = Weights::at(dz(o), dy(o), dx(o));
+            if ( weight != 0 ) {
+                acc += weight * p[dz(o) * stride_z + dy(o) * stride_y + dx(o)];
+            }
+        };
+        unrolled_for<0, num_of_offsets>::run(term);
+        return acc;
+    }
+
+    /**
+     * @description: a point within R of an edge, with the boundary policy
+     */
+    template <typename T>
+    static inline T edge_point(const T* in, const std::array<int, 3>& shape, int z, int y, int x) {
+        if ( Boundary == stencil_boundary::skip ) {
+            return in[((long long)z * shape[1] + y) * shape[2] + x];
+        }
+        T acc = 0;
+        auto term = [&](auto offset) {
+            constexpr int o = decltype(offset)::value;
+            constexpr double weight = Weights::at(dz(o), dy(o), dx(o));
+            if ( weight != 0 ) {
+                const int zz = D >= 3 ? boundary_index(z + dz(o), shape[0]) : z;
+                const int yy = D >= 2 ? boundary_index(y + dy(o), shape[1]) : y;
+                const int xx = boundary_index(x + dx(o), shape[2]);
+                acc += weight * in[((long long)zz * shape[1] + yy) * shape[2] + xx];
+            }
+        };
+        unrolled_for<0, num_of_offsets>::run(term);
+        return acc;
+    }
+
+    /**
+     * @description: the points [x0, x1) of row (z, y)
+     */
+    template <typename T>
+    static inline void row(const T* in, T* out, const std::array<int, 3>& shape, int z, int y, int x0, int x1) {
+        const long long stride_y = shape[2];
+        const long long stride_z = (long long)shape[1] * shape[2];
+        const long long base = z * stride_z + y * stride_y;
+        const bool interior_row = (D < 2 || (y >= R && y < shape[1] - R)) && (D < 3 || (z >= R && z < shape[0] - R));
+        const int first_interior = interior_row ? std::min(x1, std::max(x0, R)) : x1;
+        const int last_interior = interior_row ? std::max(first_interior, std::min(x1, shape[2] - R)) : x1;
+
+        for ( int x = x0; x < first_interior; x++ ) {
+            out[base + x] = edge_point(in, shape, z, y, x);
+        }
+        const T* p = in + base;
+        T* q = out + base;
+        for ( int x = first_interior; x < last_interior; x++ ) {
+            q[x] = interior_point(p + x, stride_z, stride_y);
+        }
+        for ( int x = last_interior; x < x1; x++ ) {
+            out[base + x] = edge_point(in, shape, z, y, x);
+        }
+    }
+};
+
+
+/**
+ * @description: apply a stencil M times, one parallel region with a barrier per iteration
+ * @param {T* a} the grid, shape[0] * shape[1] * shape[2] points
+ * @param {T* b} a second buffer of the same size; both a and b hold the result
+ * @param {std::array<int, 3>} shape: {nz, ny, nx}, with nz = 1 for 2D, and nz = ny = 1 for 1D
+ * @param {int M} the number of iterations
+ * @param {int num_of_threads} the number of threads
+ * @param {std::array<int, 3>} block: the block size {block_z, block_y, block_x}
+*/
+template <typename Stencil, typename T>
+void stencil_iterate(T* a, T* b, std::array<int, 3> shape, int M, int num_of_threads, std::array<int, 3> block) {
+    const int blocks_z = (shape[0] + block[0] - 1) / block[0];
+    const int blocks_y = (shape[1] + block[1] - 1) / block[1];
+    const int blocks_x = (shape[2] + block[2] - 1) / block[2];
+    const long long num_of_blocks = (long long)blocks_z * blocks_y * blocks_x;
+    const long long size = (long long)shape[0] * shape[1] * shape[2];
+    if ( M <= 0 || size == 0 ) {
+        return;
+    }
+
+    #pragma omp parallel num_threads(num_of_threads)
+    {
+        T* in = a;
+        T* out = b;
+        for ( int i = 0; i < M; i++ ) {
+            #pragma omp for schedule(static)
+            for ( long long k = 0; k < num_of_blocks; k++ ) {
+                const int z0 = (int)(k / ((long long)blocks_y * blocks_x)) * block[0];
+                const int y0 = (int)(k / blocks_x % blocks_y) * block[1];
+                const int x0 = (int)(k % blocks_x) * block[2];
+                const int z1 = std::min(shape[0], z0 + block[0]);
+                const int y1 = std::min(shape[1], y0 + block[1]);
+                const int x1 = std::min(shape[2], x0 + block[2]);
+                for ( int z = z0; z < z1; z++ ) {
+                    for ( int y = y0; y < y1; y++ ) {
+                        Stencil::row(in, out, shape, z, y, x0, x1);
+                    }
+                }
+            }
+            // the implicit barrier of the omp for ends the iteration
+            std::swap(in, out);
+        }
+
+        // the result is in the last output; copy it into the other buffer
+        #pragma omp for schedule(static)
+        for ( long long k = 0; k < size; k++ ) {
+            out[k] = in[k];
+        }
+    }
+}
+
+/**
+ * @description: apply a stencil M times with the default block size
+*/
+template <typename Stencil, typename T>
+void stencil_iterate(T* a, T* b, std::array<int, 3> shape, int M, int num_of_threads) {
+    stencil_iterate<Stencil>(a, b, shape, M, num_of_threads, {STENCIL_BLOCK_Z, STENCIL_BLOCK_Y, STENCIL_BLOCK_X});
+}
+
+
+/**
+ * @description: 3x3 Gaussian blur, (1 2 1)^T (1 2 1) / 16
+ */
+struct gaussian_blur_weights {
+    static constexpr double at(int, int dy, int dx) {
+        return (dy == 0 ? 2 : 1) * (dx == 0 ? 2 : 1) / 16.0;
+    }
+};
+
+/**
+ * @description: one explicit step of the heat equation, with diffusion number 1/8 for each of the 6 neighbours
+ */
+struct heat_diffusion_weights {
+    static constexpr double at(int dz, int dy, int dx) {
+        return dz == 0 && dy == 0 && dx == 0 ? 1 - 6 * 0.125
+             : dz * dz + dy * dy + dx * dx == 1 ? 0.125 : 0;
+    }
+};
+
+using vector_smoothing_stencil = stencil<1, 2, smoothing_weights, stencil_boundary::skip>;
+using image_blur_stencil = stencil<2, 1, gaussian_blur_weights, stencil_boundary::clamp>;
+using heat_diffusion_stencil = stencil<3, 1, heat_diffusion_weights, stencil_boundary::periodic>;
+
+/**
+ * @description: stencil engine version of repetitive smoothing of a vector
+ * @param {int* v} pre-initialized array of length N
+ * @param {int* s} the smoothed version of v, preinitialized with v
+ * @param {int M} the number of iterations
+ * @param {int num_of_threads} the number of threads
+*/
+void stencil_vector_repetitive_smoothing(int* v, int* s, int N, int M, int num_of_threads) {
+    stencil_iterate<vector_smoothing_stencil>(v, s, {1, 1, N}, M, num_of_threads);
+}
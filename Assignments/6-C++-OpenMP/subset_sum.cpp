@@ -0,0 +1,193 @@
+#include <vector>
+#include <map>
+#include <cstdint>
+#include <algorithm>    // std::min, std::sort
+#include <utility>      // std::swap
+#include <omp.h>        /* openMP */
+#ifdef __AVX2__
+#include <immintrin.h>  // AVX2 intrinsics
+#endif
+
+/*
+    Bit-parallel subset sum: the knapsack with v[i] = w[i], when the only questions are whether a capacity is
+    reachable exactly, and what the heaviest load within C is.
+
+    Bit j of reach is set if some subset of the items weighs exactly j. One item of weight w updates it with
+        reach |= reach << w
+    which handles 64 capacities per word and 256 per AVX2 vector, instead of one int per capacity.
+    Bitsets longer than SUBSET_SUM_PARALLEL_WORDS words are split between threads. Those threads read
+    the current bitset and write the next one, and every item ends with a barrier.
+
+    Many items of the same weight w are grouped in binary. c copies of w become items of weight
+    w, 2w, 4w, ..., and a last one of the remaining copies, so c shifts become about log2(c) shifts.
+    Every count from 0 to c is still reachable.
+
+    The weights are applied lightest first. No subset sum can exceed the total weight applied so far,
+    so each shift only touches the words up to that total.
+*/
+
+const int SUBSET_SUM_PARALLEL_WORDS = 1 << 14;      // by default, shorter bitsets are updated by one thread
+
+
+/**
+ * @description: dst[k] = src[k] | (src << (64 * q + r))[k] for k in [lo, hi), from high k to low k,
+ *               so that dst may be src
+ */
+inline void shift_or_words(const uint64_t* src, uint64_t* dst, long long lo, long long hi, long long q, int r) {
+    long long k = hi - 1;
+    // words k with k - q - 1 >= 0 read two source words
+#ifdef __AVX2__
+    const __m128i left = _mm_cvtsi32_si128(r);
+    const __m128i right = _mm_cvtsi32_si128(64 - r);
+    for ( ; k - 3 >= lo && k - 3 - q - 1 >= 0; k -= 4 ) {
+        __m256i low = _mm256_loadu_si256((const __m256i*)(src + k - 3 - q - 1));
+        __m256i high = _mm256_loadu_si256((const __m256i*)(src + k - 3 - q));
+        __m256i shifted = _mm256_or_si256(_mm256_sll_epi64(high, left), _mm256_srl_epi64(low, right));
+        __m256i current = _mm256_loadu_si256((const __m256i*)(src + k - 3));
+        _mm256_storeu_si256((__m256i*)(dst + k - 3), _mm256_or_si256(current, shifted));
+    }
+#endif
+    for ( ; k >= lo; k-- ) {
+        uint64_t shifted = 0;
+        if ( k - q >= 0 ) {
+            shifted = src[k - q] << r;
+            if ( r != 0 && k - q - 1 >= 0 ) {
+                shifted |= src[k - q - 1] >> (64 - r);
+            }
+        }
+        dst[k] = src[k] | shifted;
+    }
+}
+
+/**
+ * @description: weights after binary grouping of equal weights, without the weights above C
+ */
+std::vector<long long> group_subset_sum_weights(const int* w, int N, int C) {
+    std::map<int, long long> counts;
+    for ( int i = 0; i < N; i++ ) {
+        if ( w[i] <= C ) {
+            counts[w[i]]++;
+        }
+    }
+    std::vector<long long> grouped;
+    for ( const auto& entry : counts ) {
+        long long remaining = entry.second;
+        for ( long long copies = 1; remaining > 0; copies *= 2 ) {
+            long long taken = std::min(copies, remaining);
+            if ( taken * entry.first <= C ) {
+                grouped.push_back(taken * entry.first);
+            }
+            remaining -= taken;
+        }
+    }
+    std::sort(grouped.begin(), grouped.end());
+    return grouped;
+}
+
+/**
+ * @description: the subset sums of the items up to C
+ * @param {int* w} a constant and non-negative array of length N
+ * @param {int C} the largest sum of interest
+ * @param {int N} the number of items
+ * @param {int num_of_threads} the number of threads for long bitsets
+ * @param {long long parallel_words} shorter bitsets are updated by one thread
+ * @return {std::vector<uint64_t>} bit j is set if a subset weighs exactly j, for j in [0, C]
+*/
+std::vector<uint64_t> subset_sum_reachable(int* w, int C, int N, int num_of_threads, long long parallel_words) {
+    const long long num_of_words = (long long)C / 64 + 1;
+    const uint64_t last_word_mask = C % 64 == 63 ? ~0ULL : (1ULL << (C % 64 + 1)) - 1;
+    const std::vector<long long> weights = group_subset_sum_weights(w, N, C);
+
+    std::vector<uint64_t> reach(num_of_words, 0);
+    reach[0] = 1;
+
+    if ( num_of_words < parallel_words || num_of_threads < 2 ) {
+        long long total = 0;
+        for ( long long weight : weights ) {
+            total += weight;
+            const long long end = std::min(num_of_words, total / 64 + 1);
+            shift_or_words(reach.data(), reach.data(), 0, end, weight / 64, (int)(weight % 64));
+            reach[num_of_words - 1] &= last_word_mask;
+        }
+        return reach;
+    }
+
+    std::vector<uint64_t> next(num_of_words, 0);
+    #pragma omp parallel num_threads(num_of_threads)
+    {
+        // every thread swaps its own copy of the pointers after the barrier that ends an item;
+        // the words above the total weight are zero in both bitsets, so they are skipped
+        uint64_t* current = reach.data();
+        uint64_t* updated = next.data();
+        const int thread_id = omp_get_thread_num();
+        const int team_size = omp_get_num_threads();
+        const long long lo = num_of_words * thread_id / team_size;
+        const long long hi = num_of_words * (thread_id + 1) / team_size;
+
+        long long total = 0;
+        for ( long long weight : weights ) {
+            total += weight;
+            const long long end = std::min(hi, total / 64 + 1);
+            if ( lo < end ) {
+                shift_or_words(current, updated, lo, end, weight / 64, (int)(weight % 64));
+            }
+            if ( hi == num_of_words ) {
+                updated[num_of_words - 1] &= last_word_mask;
+            }
+            std::swap(current, updated);
+            #pragma omp barrier
+        }
+    }
+    if ( weights.size() % 2 == 1 ) {
+        reach.swap(next);
+    }
+    return reach;
+}
+
+/**
+ * @description: the subset sums of the items up to C, with threads for bitsets of SUBSET_SUM_PARALLEL_WORDS words
+ *               and more
+*/
+std::vector<uint64_t> subset_sum_reachable(int* w, int C, int N, int num_of_threads) {
+    return subset_sum_reachable(w, C, N, num_of_threads, SUBSET_SUM_PARALLEL_WORDS);
+}
+
+/**
+ * @description: whether some subset of the items weighs exactly target
+ * @param {int* w} a constant and non-negative array of length N
+ * @param {int target} the sum to reach
+ * @param {int N} the number of items
+ * @param {int num_of_threads} the number of threads for long bitsets
+ * @return {bool} if target is a subset sum, return true
+*/
+bool subset_sum_feasible(int* w, int target, int N, int num_of_threads) {
+    if ( target < 0 ) {
+        return false;
+    }
+    std::vector<uint64_t> reach = subset_sum_reachable(w, target, N, num_of_threads);
+    return (reach[target / 64] >> (target % 64)) & 1;
+}
+
+/**
+ * @description: the largest set bit of a bitset from subset_sum_reachable
+ */
+int highest_subset_sum(const std::vector<uint64_t>& reach) {
+    for ( long long k = (long long)reach.size() - 1; k >= 0; k-- ) {
+        if ( reach[k] != 0 ) {
+            return (int)(64 * k + 63 - __builtin_clzll(reach[k]));
+        }
+    }
+    return 0;
+}
+
+/**
+ * @description: the heaviest subset within the capacity, the knapsack optimum with v[i] = w[i]
+ * @param {int* w} a constant and non-negative array of length N
+ * @param {int C} the capacity
+ * @param {int N} the number of items
+ * @param {int num_of_threads} the number of threads for long bitsets
+ * @return {int} the largest subset sum not above C
+*/
+int subset_sum_best_weight(int* w, int C, int N, int num_of_threads) {
+    return highest_subset_sum(subset_sum_reachable(w, C, N, num_of_threads));
+}
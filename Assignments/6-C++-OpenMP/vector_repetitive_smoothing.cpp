@@ -1,7 +1,17 @@
 #include <iostream>
 #include <chrono>       /* time manipulation */
 #include <omp.h>        /* openMP */
-#include <stdlib.h>     /* random number */
+#include <stdlib.h>     /* RAND_MAX */
+#include <cmath>        // std::abs
+#include <vector>
+#include <algorithm>    // std::min_element, std::max_element
+
+#include "openMP_cost_model.cpp"
+#include "smoothing_temporal_blocking.cpp"
+#include "smoothing_stencil_kernel.cpp"
+#include "stencil_engine.cpp"
+#include "smoothing_fft.cpp"
+#include "../5-C++-Threads-and-Synchronization/counter_rng.cpp"
 
 
 /**
@@ -29,16 +39,14 @@ void sequential_vector_repetitive_smoothing(int* v, int* s, int N, int M) {
  * @param {int* v} pre-initialized array of length N
  * @param {int* s} the smoothed version of v, preinitialized with v
  * @param {int M} the number of iterations
+ * @param {int num_of_threads} the number of threads
 */
-void openMP_vector_repetitive_smoothing(int* v, int* s, int N, int M) {
-
-    const int max_num_of_threads = omp_get_max_threads();
-    std::cout<< "number of threads: " << max_num_of_threads << std::endl;
+void openMP_vector_repetitive_smoothing(int* v, int* s, int N, int M, int num_of_threads) {
 
     for (int i = 0; i < M; i++) {
 
         int k = -2;
-        #pragma omp parallel for private(k) num_threads(max_num_of_threads)
+        #pragma omp parallel for private(k) num_threads(num_of_threads)
         for (int j = 2; j < N - 2; j++) {
             s[j] = 0;
             for (k = -2; k < 3; k++) {
@@ -46,13 +54,67 @@ void openMP_vector_repetitive_smoothing(int* v, int* s, int N, int M) {
             }
         }
 
-        #pragma omp parallel for num_threads(max_num_of_threads)
+        #pragma omp parallel for num_threads(num_of_threads)
         for (int j = 0; j < N; j++) {
             v[j] = s[j];
         }
     }
 }
 
+/**
+ * @description: openMP version of repetitive smoothing of a vector, with the maximum number of threads
+ * @param {int* v} pre-initialized array of length N
+ * @param {int* s} the smoothed version of v, preinitialized with v
+ * @param {int M} the number of iterations
+*/
+void openMP_vector_repetitive_smoothing(int* v, int* s, int N, int M) {
+
+    const int max_num_of_threads = omp_get_max_threads();
+    std::cout<< "number of threads: " << max_num_of_threads << std::endl;
+
+    openMP_vector_repetitive_smoothing(v, s, N, M, max_num_of_threads);
+}
+
+/**
+ * @description: calibrate the sequential smoothing kernel, one iteration over a sample vector, unless it is cached
+ * @param {CostModel&} model: the cost model to calibrate
+ */
+void calibrate_vector_repetitive_smoothing(CostModel& model) {
+    const int sample_size = 1 << 16;
+    int* v = new int[sample_size];
+    int* s = new int[sample_size];
+    for ( int i = 0; i < sample_size; i++ ) {
+        v[i] = i;
+        s[i] = i;
+    }
+    model.calibrate_kernel("smoothing", sample_size, [v, s, sample_size]() {
+        sequential_vector_repetitive_smoothing(v, s, sample_size, 1);
+    });
+    delete[] v;
+    delete[] s;
+}
+
+/**
+ * @description: repetitive smoothing of a vector, sequential or openMP with the number of threads
+ *               the cost model predicts is fastest for N points and two parallel regions per iteration
+ * @param {int* v} pre-initialized array of length N
+ * @param {int* s} the smoothed version of v, preinitialized with v
+ * @param {int M} the number of iterations
+ * @param {const CostModel&} model: a cost model calibrated by calibrate_vector_repetitive_smoothing
+*/
+void dispatched_vector_repetitive_smoothing(int* v, int* s, int N, int M, const CostModel& model) {
+
+    const int num_of_threads = model.choose_threads("openmp", "smoothing", N, 2);
+    std::cout<< "number of threads: " << num_of_threads << std::endl;
+
+    if ( num_of_threads == 1 ) {
+        sequential_vector_repetitive_smoothing(v, s, N, M);
+    }
+    else {
+        openMP_vector_repetitive_smoothing(v, s, N, M, num_of_threads);
+    }
+}
+
 /**
  * @description: validate the result from two matrix multiplication method
  * @param {int*} A: matrix A
@@ -75,6 +137,253 @@ bool validate_result(int* A, int* B, int size) {
     return true;
 }
 
+/**
+ * @description: the largest absolute difference between two vectors
+ * @param {int*} A: vector A
+ * @param {int*} B: vector B
+ * @param {int} size: the size of array
+ * @return {long long} max |A[i] - B[i]|
+ */
+long long max_difference(int* A, int* B, int size) {
+    long long difference = 0;
+    for ( int i = 0; i < size; i++ ) {
+        difference = std::max(difference, std::abs((long long)A[i] - B[i]));
+    }
+    return difference;
+}
+
+/**
+ * @description: compare the temporally blocked and double buffered exact versions with the sequential one on
+ *               short vectors, with more threads than points and tiles shorter than their halos
+ */
+void smoothing_of_small_instances() {
+    const int lengths[] = {0, 1, 2, 3, 4, 5, 6, 9, 17, 40};
+    const int iterations[] = {1, 2, 3, 7};
+    const int tile_sizes[] = {1, 2, 3};
+    bool correct = true;
+    for ( int N : lengths ) {
+        for ( int M : iterations ) {
+            std::vector<int> v(N);
+            random_fill_integers(v.data(), N, 0, RAND_MAX, DEFAULT_RANDOM_SEED + 4, 1);
+            std::vector<int> s(v);
+            sequential_vector_repetitive_smoothing(v.data(), s.data(), N, M);
+            for ( int num_of_threads = 3; num_of_threads <= 4; num_of_threads++ ) {
+                for ( int tile_size : tile_sizes ) {
+                    std::vector<int> v_blocked(N);
+                    random_fill_integers(v_blocked.data(), N, 0, RAND_MAX, DEFAULT_RANDOM_SEED + 4, 1);
+                    std::vector<int> s_blocked(v_blocked);
+                    temporally_blocked_vector_repetitive_smoothing(v_blocked.data(), s_blocked.data(), N, M,
+                                                                   num_of_threads, tile_size);
+                    correct = correct && v_blocked == v && s_blocked == s;
+                }
+                std::vector<int> v_exact(N);
+                random_fill_integers(v_exact.data(), N, 0, RAND_MAX, DEFAULT_RANDOM_SEED + 4, 1);
+                std::vector<int> s_exact(v_exact);
+                double_buffered_vector_repetitive_smoothing(v_exact.data(), s_exact.data(), N, M, num_of_threads, true);
+                correct = correct && v_exact == v && s_exact == s;
+            }
+        }
+    }
+    std::cout << "Running temporally blocked and double buffered versions on vectors of 0 to 40 points, 3 and 4 threads: " << std::endl;
+    std::cout << "validating results: " << std::boolalpha << correct << std::endl;
+    std::cout << "============================================" << std::endl;
+}
+
+/**
+ * @description: apply stencil<D, R, Weights, Boundary> M times with a plain loop over every point and offset
+ * @param {std::vector<T>} a: the grid, shape[0] * shape[1] * shape[2] points
+ * @return {std::vector<T>} the grid after M iterations
+ */
+template <int D, int R, typename Weights, stencil_boundary Boundary, typename T>
+std::vector<T> naive_stencil_iterate(std::vector<T> a, std::array<int, 3> shape, int M) {
+    const int rz = D >= 3 ? R : 0;
+    const int ry = D >= 2 ? R : 0;
+    auto index = [](int i, int n) {
+        return Boundary == stencil_boundary::clamp ? std::min(n - 1, std::max(0, i)) : ((i % n) + n) % n;
+    };
+    std::vector<T> b(a.size());
+    for ( int i = 0; i < M; i++ ) {
+        for ( int z = 0; z < shape[0]; z++ ) {
+            for ( int y = 0; y < shape[1]; y++ ) {
+                for ( int x = 0; x < shape[2]; x++ ) {
+                    const long long point = ((long long)z * shape[1] + y) * shape[2] + x;
+                    const bool edge = x < R || x >= shape[2] - R || (D >= 2 && (y < R || y >= shape[1] - R))
+                                   || (D >= 3 && (z < R || z >= shape[0] - R));
+                    if ( edge && Boundary == stencil_boundary::skip ) {
+                        b[point] = a[point];
+                        continue;
+                    }
+                    T acc = 0;
+                    for ( int dz = -rz; dz <= rz; dz++ ) {
+                        for ( int dy = -ry; dy <= ry; dy++ ) {
+                            for ( int dx = -R; dx <= R; dx++ ) {
+                                const double weight = Weights::at(dz, dy, dx);
+                                if ( weight != 0 ) {
+                                    acc += weight * a[((long long)index(z + dz, shape[0]) * shape[1]
+                                                       + index(y + dy, shape[1])) * shape[2] + index(x + dx, shape[2])];
+                                }
+                            }
+                        }
+                    }
+                    b[point] = acc;
+                }
+            }
+        }
+        std::swap(a, b);
+    }
+    return a;
+}
+
+/**
+ * @description: the largest difference between the stencil engine and the plain loop, with the given blocks
+ * @param {std::array<int, 3>} shape: {nz, ny, nx}
+ * @param {std::array<int, 3>} block: the block size {block_z, block_y, block_x}
+ * @param {int} high: the points start as random integers in [0, high)
+ */
+template <int D, int R, typename Weights, stencil_boundary Boundary, typename T>
+double stencil_difference_from_naive(std::array<int, 3> shape, int M, int num_of_threads, std::array<int, 3> block, int high) {
+    const long long size = (long long)shape[0] * shape[1] * shape[2];
+    std::vector<T> a(size);
+    std::vector<T> b(size);
+    random_fill_integers(a.data(), size, 0, high, DEFAULT_RANDOM_SEED + 5, 1);
+    const std::vector<T> expected = naive_stencil_iterate<D, R, Weights, Boundary>(a, shape, M);
+    stencil_iterate<stencil<D, R, Weights, Boundary>>(a.data(), b.data(), shape, M, num_of_threads, block);
+    double difference = 0;
+    for ( long long k = 0; k < size; k++ ) {
+        difference = std::max(difference, (double)std::abs(a[k] - expected[k]));
+        difference = std::max(difference, (double)std::abs(b[k] - expected[k]));
+    }
+    return difference;
+}
+
+/**
+ * @description: run the 2D blur and the 3D heat diffusion instances of the stencil engine
+ * @param {int} M: the number of iterations
+ */
+void stencil_engine_examples(int M) {
+    std::chrono::steady_clock::time_point start_time;
+    std::chrono::duration<double> duration;
+
+    // a blur never leaves the range of the image
+    const int height = 2048;
+    const int width = 2048;
+    std::vector<float> image(height * width);
+    std::vector<float> image_buffer(height * width);
+    random_fill_integers(image.data(), height * width, 0, 256, DEFAULT_RANDOM_SEED + 1, omp_get_max_threads());
+    std::cout << "Running stencil engine 2D blur, " << height << " x " << width << ", clamped edges: " << std::endl;
+    start_time = std::chrono::steady_clock::now();
+    stencil_iterate<image_blur_stencil>(image.data(), image_buffer.data(), {1, height, width}, M, omp_get_max_threads());
+    duration = std::chrono::steady_clock::now() - start_time;
+    std::cout << "it takes " << duration.count() << " seconds." << std::endl;
+    const bool in_range = *std::min_element(image.begin(), image.end()) >= 0
+                       && *std::max_element(image.begin(), image.end()) <= 255;
+    std::cout << "validating results: " << std::boolalpha << in_range << std::endl;
+    // small images whose sides are not multiples of the blocks, against the plain loop
+    double blur_difference = 0;
+    for ( int num_of_threads = 1; num_of_threads <= 3; num_of_threads++ ) {
+        blur_difference = std::max(blur_difference, stencil_difference_from_naive<2, 1, gaussian_blur_weights, stencil_boundary::clamp, float>(
+            {1, 37, 45}, M, num_of_threads, {1, 5, 7}, 256));
+        blur_difference = std::max(blur_difference, stencil_difference_from_naive<2, 1, gaussian_blur_weights, stencil_boundary::clamp, float>(
+            {1, 3, 2}, M, num_of_threads, {1, 2, 3}, 256));
+    }
+    std::cout << "largest difference from the plain loop on 37 x 45 and 3 x 2 images: " << blur_difference << std::endl;
+    std::cout << "validating results: " << std::boolalpha << (blur_difference <= 1e-3) << std::endl;
+    std::cout << "============================================" << std::endl;
+
+    // periodic diffusion keeps the total heat
+    const int side = 128;
+    std::vector<double> heat(side * side * side);
+    std::vector<double> heat_buffer(side * side * side);
+    random_fill_integers(heat.data(), side * side * side, 0, 1000, DEFAULT_RANDOM_SEED + 2, omp_get_max_threads());
+    double total = 0;
+    for ( double point : heat ) {
+        total += point;
+    }
+    std::cout << "Running stencil engine 3D heat diffusion, " << side << "^3, periodic edges: " << std::endl;
+    start_time = std::chrono::steady_clock::now();
+    stencil_iterate<heat_diffusion_stencil>(heat.data(), heat_buffer.data(), {side, side, side}, M, omp_get_max_threads());
+    duration = std::chrono::steady_clock::now() - start_time;
+    std::cout << "it takes " << duration.count() << " seconds." << std::endl;
+    double total_after = 0;
+    for ( double point : heat ) {
+        total_after += point;
+    }
+    std::cout << "validating results: " << std::boolalpha << (std::abs(total_after - total) <= 1e-9 * total) << std::endl;
+    // small grids whose sides are not multiples of the blocks, against the plain loop
+    double heat_difference = 0;
+    for ( int num_of_threads = 1; num_of_threads <= 3; num_of_threads++ ) {
+        heat_difference = std::max(heat_difference, stencil_difference_from_naive<3, 1, heat_diffusion_weights, stencil_boundary::periodic, double>(
+            {11, 13, 17}, M, num_of_threads, {4, 5, 8}, 1000));
+        heat_difference = std::max(heat_difference, stencil_difference_from_naive<3, 1, heat_diffusion_weights, stencil_boundary::periodic, double>(
+            {2, 3, 1}, M, num_of_threads, {3, 2, 2}, 1000));
+    }
+    std::cout << "largest difference from the plain loop on 11 x 13 x 17 and 2 x 3 x 1 grids: " << heat_difference << std::endl;
+    std::cout << "validating results: " << std::boolalpha << (heat_difference <= 1e-9) << std::endl;
+    std::cout << "============================================" << std::endl;
+}
+
+/**
+ * @description: double precision smoothing with many iterations: the direct stencil, the FFT and the dispatcher,
+ *               each against the sequential double precision version
+ * @param {int} N: the length of the vector
+ * @param {int} M: the number of iterations
+ */
+void fft_smoothing_of_a_large_instance(int N, int M) {
+    std::chrono::steady_clock::time_point start_time;
+    std::chrono::duration<double> duration;
+
+    std::vector<double> v(N);
+    random_fill_integers(v.data(), N, 0, RAND_MAX, DEFAULT_RANDOM_SEED + 3, omp_get_max_threads());
+    const double bound = smoothing_fft_error_bound(v.data(), N, M);
+    std::vector<double> s(v);
+    std::vector<double> v_direct(v);
+    std::vector<double> s_direct(v);
+    std::vector<double> v_fft(v);
+    std::vector<double> s_fft(v);
+    std::vector<double> v_dispatched(v);
+    std::vector<double> s_dispatched(v);
+
+    std::cout << "Running double precision sequential version, N = " << N << ", M = " << M << ": " << std::endl;
+    start_time = std::chrono::steady_clock::now();
+    double_vector_repetitive_smoothing(v.data(), s.data(), N, M);
+    duration = std::chrono::steady_clock::now() - start_time;
+    std::cout << "it takes " << duration.count() << " seconds." << std::endl;
+    std::cout << "============================================" << std::endl;
+
+    std::cout << "Running double precision direct version: " << std::endl;
+    start_time = std::chrono::steady_clock::now();
+    stencil_iterate<vector_smoothing_stencil>(v_direct.data(), s_direct.data(), {1, 1, N}, M, omp_get_max_threads());
+    duration = std::chrono::steady_clock::now() - start_time;
+    std::cout << "it takes " << duration.count() << " seconds." << std::endl;
+    std::cout << "============================================" << std::endl;
+
+    std::cout << "Running double precision FFT version: " << std::endl;
+    start_time = std::chrono::steady_clock::now();
+    fft_vector_repetitive_smoothing(v_fft.data(), s_fft.data(), N, M, omp_get_max_threads());
+    duration = std::chrono::steady_clock::now() - start_time;
+    std::cout << "it takes " << duration.count() << " seconds." << std::endl;
+    std::cout << "============================================" << std::endl;
+
+    std::cout << "Running double precision dispatched version, which picks "
+              << (smoothing_prefers_fft(N, M) ? "FFT" : "direct") << ": " << std::endl;
+    start_time = std::chrono::steady_clock::now();
+    dispatched_double_vector_repetitive_smoothing(v_dispatched.data(), s_dispatched.data(), N, M, omp_get_max_threads());
+    duration = std::chrono::steady_clock::now() - start_time;
+    std::cout << "it takes " << duration.count() << " seconds." << std::endl;
+    std::cout << "============================================" << std::endl;
+
+    double errors[3] = {0, 0, 0};
+    for ( int j = 0; j < N; j++ ) {
+        errors[0] = std::max(errors[0], std::max(std::abs(v_direct[j] - v[j]), std::abs(s_direct[j] - v[j])));
+        errors[1] = std::max(errors[1], std::max(std::abs(v_fft[j] - v[j]), std::abs(s_fft[j] - v[j])));
+        errors[2] = std::max(errors[2], std::max(std::abs(v_dispatched[j] - v[j]), std::abs(s_dispatched[j] - v[j])));
+    }
+    std::cout << "largest error of the direct, FFT and dispatched versions: " << errors[0] << ", " << errors[1]
+              << ", " << errors[2] << ", bound: " << bound << std::endl;
+    std::cout << "validating results: " << std::boolalpha
+              << (errors[0] <= bound && errors[1] <= bound && errors[2] <= bound) << std::endl;
+    std::cout << "============================================" << std::endl;
+}
 
 int main() {
 
@@ -86,15 +395,33 @@ int main() {
     int* s = new int[N];
     int* s_openMP = new int[N];
     int* v_openMP = new int[N];
+    int* s_dispatched = new int[N];
+    int* v_dispatched = new int[N];
+    int* s_blocked = new int[N];
+    int* v_blocked = new int[N];
+    int* s_exact = new int[N];
+    int* v_exact = new int[N];
+    int* s_fast = new int[N];
+    int* v_fast = new int[N];
+    int* s_stencil = new int[N];
+    int* v_stencil = new int[N];
 
     // initialize matrix w and v
-    // random number generator
-    srand(time(NULL));                    
+    random_fill_integers(v, N, 0, RAND_MAX, DEFAULT_RANDOM_SEED, omp_get_max_threads());
     for ( int i = 0; i < N; i++ ) {
-        v[i] = rand();
         s[i] = v[i];
         v_openMP[i] = v[i];
         s_openMP[i] = v[i];
+        v_dispatched[i] = v[i];
+        s_dispatched[i] = v[i];
+        v_blocked[i] = v[i];
+        s_blocked[i] = v[i];
+        v_exact[i] = v[i];
+        s_exact[i] = v[i];
+        v_fast[i] = v[i];
+        s_fast[i] = v[i];
+        v_stencil[i] = v[i];
+        s_stencil[i] = v[i];
     }
 
     // time manipulation
@@ -123,5 +450,64 @@ int main() {
     // validate result
     validate_result(s, s_openMP, N);
 
+    // temporally blocked version
+    start_time = std::chrono::steady_clock::now();
+    std::cout << "Running temporally blocked version: " << std::endl;
+    temporally_blocked_vector_repetitive_smoothing(v_blocked, s_blocked, N, M, omp_get_max_threads());
+    end_time = std::chrono::steady_clock::now();
+    duration = end_time - start_time;
+    std::cout << "it takes " << duration.count() << " seconds." << std::endl;
+    std::cout << "============================================" << std::endl;
+    validate_result(s, s_blocked, N);
+    validate_result(v, v_blocked, N);
+
+    // double buffered version, exact and fast kernels
+    start_time = std::chrono::steady_clock::now();
+    std::cout << "Running double buffered version with the exact kernel: " << std::endl;
+    double_buffered_vector_repetitive_smoothing(v_exact, s_exact, N, M, omp_get_max_threads(), true);
+    end_time = std::chrono::steady_clock::now();
+    duration = end_time - start_time;
+    std::cout << "it takes " << duration.count() << " seconds." << std::endl;
+    std::cout << "============================================" << std::endl;
+    validate_result(s, s_exact, N);
+    validate_result(v, v_exact, N);
+
+    start_time = std::chrono::steady_clock::now();
+    std::cout << "Running double buffered version with the fast kernel: " << std::endl;
+    double_buffered_vector_repetitive_smoothing(v_fast, s_fast, N, M, omp_get_max_threads(), false);
+    end_time = std::chrono::steady_clock::now();
+    duration = end_time - start_time;
+    std::cout << "it takes " << duration.count() << " seconds." << std::endl;
+    std::cout << "============================================" << std::endl;
+    std::cout << "largest difference from the exact result: " << max_difference(s, s_fast, N) << std::endl;
+    smoothing_of_small_instances();
+
+    // stencil engine version
+    start_time = std::chrono::steady_clock::now();
+    std::cout << "Running stencil engine version: " << std::endl;
+    stencil_vector_repetitive_smoothing(v_stencil, s_stencil, N, M, omp_get_max_threads());
+    end_time = std::chrono::steady_clock::now();
+    duration = end_time - start_time;
+    std::cout << "it takes " << duration.count() << " seconds." << std::endl;
+    std::cout << "============================================" << std::endl;
+    validate_result(s, s_stencil, N);
+    validate_result(v, v_stencil, N);
+    stencil_engine_examples(M);
+    fft_smoothing_of_a_large_instance(1 << 18, 2000);
+    fft_smoothing_of_a_large_instance(1 << 12, 2000);
+
+    // cost model dispatched version
+    CostModel model = openMP_cost_model();
+    calibrate_vector_repetitive_smoothing(model);
+    model.save();
+    start_time = std::chrono::steady_clock::now();
+    std::cout << "Running cost model dispatched version: " << std::endl;
+    dispatched_vector_repetitive_smoothing(v_dispatched, s_dispatched, N, M, model);
+    end_time = std::chrono::steady_clock::now();
+    duration = end_time - start_time; 
+    std::cout << "it takes " << duration.count() << " seconds." << std::endl;
+    std::cout << "============================================" << std::endl;
+    validate_result(s, s_dispatched, N);
+
     return 0;
 }
@@ -1,5 +1,7 @@
 #include <stdio.h>
 
+#include "../8-CUDA-Programming/cuda_cpu_backend.cpp"
+
 __global__ void hello_kernel() {
     // calculate global thread identifier, note blockIdx.x = 0 here
     const int thid = blockDim.x * blockIdx.x + threadIdx.x;
@@ -15,7 +17,7 @@ int main(int argc, char* argv[]) {
     cudaSetDevice(0);
 
     // invoke kernel using 4 threads executed in 1 thread block
-    hello_kernel<<<1, 4>>>();
+    LAUNCH_KERNEL(hello_kernel, 1, 4);
 
     // synchronize the GPU preventing premature termination
     cudaDeviceSynchronize();
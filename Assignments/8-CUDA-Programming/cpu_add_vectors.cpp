@@ -0,0 +1,179 @@
+#include <iostream>
+#include <chrono>       /* time manipulation */
+#include <thread>
+#include <vector>
+#include <algorithm>    /* std::min, std::max */
+#include <cstdint>
+#if defined(__AVX__) || defined(__AVX512F__)
+#include <immintrin.h>  /* AVX and AVX-512 intrinsics, _mm_sfence */
+#endif
+
+#include "../5-C++-Threads-and-Synchronization/counter_rng.cpp"
+
+/*
+    Multithreaded CPU engine for the vector addition z = x + y.
+
+    The addition does one flop per 12 bytes, so it is bound by memory bandwidth, and the threads only help
+    until they saturate it. Two things matter:
+        - z is written with non-temporal (streaming) stores, which go to memory without first reading
+          the cache line of z. A normal store reads that line, so it moves 16 bytes per element instead of 12.
+        - every thread but the first gets a contiguous range that starts on a 64-byte address, so no two
+          threads write the same line. new float[] only aligns z to 16 bytes, so the split points are
+          counted from the first cache line boundary inside z, and the first range also covers the floats
+          before it.
+    Compile with -march=native to enable the AVX-512 or AVX streaming paths; without them the loop is scalar.
+
+    The bounded-memory mode never allocates the whole vectors. Every thread generates x and y in pieces of
+    chunk_size elements, adds them, and checks the sums, all while the piece is in its cache. The inputs are
+    the counter-based streams of counter_rng.cpp, a function of the seed and the element index only, so they are
+    the same as random_fill_integers gives for whole vectors. Each sum is checked against x[i] + y[i] computed in
+    integers straight from random_bits, and the checksum is an integer sum, so the result does not depend on the
+    number of threads. Normal stores suit the pieces better, because a piece is read again right away, but the
+    streaming path can be run on them too.
+
+    The bandwidth is compared against the STREAM "Add" kernel, c[i] = a[i] + b[i], measured here on the same
+    arrays with normal stores. That kernel is counted as 12 bytes per element, like STREAM does, although the
+    write allocate really moves 16.
+*/
+
+const long long CACHE_LINE_FLOATS{16};
+const long long CHUNK_SIZE{1 << 14};        // floats per piece, 3 pieces of 64 KiB per thread
+
+/**
+ * @description: z[i] = x[i] + y[i] for i in [first, last)
+ * @param {bool} streaming_stores: write z with non-temporal stores
+ */
+inline void add_vectors_range(const float* x, const float* y, float* z, long long first, long long last, bool streaming_stores) {
+    long long i = first;
+#if defined(__AVX512F__)
+    if ( streaming_stores ) {
+        for ( ; i < last && ((uintptr_t)(z + i) & 63) != 0; i++ ) {
+            z[i] = x[i] + y[i];
+        }
+        for ( ; i + 16 <= last; i += 16 ) {
+            _mm512_stream_ps(z + i, _mm512_add_ps(_mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i)));
+        }
+        _mm_sfence();
+    }
+#elif defined(__AVX__)
+    if ( streaming_stores ) {
+        for ( ; i < last && ((uintptr_t)(z + i) & 31) != 0; i++ ) {
+            z[i] = x[i] + y[i];
+        }
+        for ( ; i + 8 <= last; i += 8 ) {
+            _mm256_stream_ps(z + i, _mm256_add_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i)));
+        }
+        _mm_sfence();
+    }
+#endif
+    for ( ; i < last; i++ ) {
+        z[i] = x[i] + y[i];
+    }
+}
+
+/**
+ * @description: multithreaded vector addition
+ * @param {float*} x: vector x
+ * @param {float*} y: vector y
+ * @param {float*} z: vector z, the addition of x and y
+ * @param {long long} length: the length of vectors
+ * @param {int} num_of_threads: the number of threads
+ * @param {bool} streaming_stores: write z with non-temporal stores
+ */
+void parallel_add_vectors(const float* x, const float* y, float* z, long long length, int num_of_threads, bool streaming_stores) {
+    // ranges of whole cache lines, counted from the first 64-byte address in z; the floats before it go to thread 0
+    const long long head = std::min(length, (long long)((64 - ((uintptr_t)z & 63)) & 63) / (long long)sizeof(float));
+    const long long lines = (length - head + CACHE_LINE_FLOATS - 1) / CACHE_LINE_FLOATS;
+    std::vector<std::thread> threads;
+    for ( int t = 0; t < num_of_threads; t++ ) {
+        const long long first = t == 0 ? 0 : std::min(length, head + lines * t / num_of_threads * CACHE_LINE_FLOATS);
+        const long long last = std::min(length, head + lines * (t + 1) / num_of_threads * CACHE_LINE_FLOATS);
+        threads.push_back(std::thread(add_vectors_range, x, y, z, first, last, streaming_stores));
+    }
+    for ( std::thread& thread : threads ) {
+        thread.join();
+    }
+}
+
+/**
+ * @description: result of the bounded-memory vector addition
+ */
+struct chunked_add_result {
+    long long mismatches;   // elements of z that differ from the expected sum
+    long long checksum;     // the sum of all elements of z, exact since they are integers
+};
+
+/**
+ * @description: generate, add and verify x + y piece by piece, without allocating the vectors
+ * @param {long long} length: the length of vectors
+ * @param {long long} chunk_size: the number of elements per piece
+ * @param {int} num_of_threads: the number of threads
+ * @param {int} max_val: the inputs are in [0, max_val)
+ * @param {uint64_t} seed: x is the stream of seed, y the stream of seed + 1
+ * @param {bool} streaming_stores: write each piece of z with non-temporal stores
+ */
+chunked_add_result chunked_add_vectors(long long length, long long chunk_size, int num_of_threads, int max_val, uint64_t seed,
+                                       bool streaming_stores) {
+    const long long num_of_chunks = (length + chunk_size - 1) / chunk_size;
+    const uint64_t key_x = random_key(seed);
+    const uint64_t key_y = random_key(seed + 1);
+    std::vector<long long> mismatches(num_of_threads, 0);
+    std::vector<long long> checksums(num_of_threads, 0);
+
+    auto work = [&](int t) {
+        std::vector<float> x(chunk_size);
+        std::vector<float> y(chunk_size);
+        std::vector<float> z(chunk_size);
+        for ( long long c = t; c < num_of_chunks; c += num_of_threads ) {
+            const long long first = c * chunk_size;
+            const long long count = std::min(chunk_size, length - first);
+            random_integers(x.data(), first, first + count, 0, max_val, seed);
+            random_integers(y.data(), first, first + count, 0, max_val, seed + 1);
+            add_vectors_range(x.data(), y.data(), z.data(), 0, count, streaming_stores);
+            long long mismatch = 0;
+            long long checksum = 0;
+            for ( long long i = 0; i < count; i++ ) {
+                // x[i] + y[i] in integers, the same numbers in [0, max_val) that random_integers maps
+                const long long expected = (long long)((random_bits(key_x, first + i) >> 32) * max_val >> 32)
+                                         + (long long)((random_bits(key_y, first + i) >> 32) * max_val >> 32);
+                mismatch += (long long)z[i] != expected;
+                checksum += (long long)z[i];
+            }
+            mismatches[t] += mismatch;
+            checksums[t] += checksum;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for ( int t = 0; t < num_of_threads; t++ ) {
+        threads.push_back(std::thread(work, t));
+    }
+    for ( std::thread& thread : threads ) {
+        thread.join();
+    }
+
+    chunked_add_result result = {0, 0};
+    for ( int t = 0; t < num_of_threads; t++ ) {
+        result.mismatches += mismatches[t];
+        result.checksum += checksums[t];
+    }
+    return result;
+}
+
+/**
+ * @description: the STREAM "Add" bandwidth, the best of several runs of c = a + b with normal stores
+ * @param {long long} length: the length of the arrays, well beyond the last level cache
+ * @param {int} num_of_threads: the number of threads
+ * @param {int} trials: the number of runs
+ * @return {double} GB/s, counting 12 bytes per element
+ */
+double stream_add_bandwidth(const float* a, const float* b, float* c, long long length, int num_of_threads, int trials) {
+    double best = 1e30;
+    for ( int trial = 0; trial < trials; trial++ ) {
+        std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+        parallel_add_vectors(a, b, c, length, num_of_threads, false);
+        std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start_time;
+        best = std::min(best, duration.count());
+    }
+    return 3.0 * sizeof(float) * length / best / 1e9;
+}
@@ -0,0 +1,257 @@
+#include <iostream>
+#include <chrono>       /* time manipulation */
+#include <thread>
+#include <cstring>      /* std::memcpy */
+
+#include "cpu_add_vectors.cpp"
+#include "vector_expressions.cpp"
+#include "../5-C++-Threads-and-Synchronization/reproducible_sum.cpp"
+
+const long long LENGTH{1LL << 30};
+const long long MATERIALIZED_LENGTH{1LL << 26};
+const int MAX_VAL{1 << 4};
+
+/**
+ * @description: sequential version of vector addition
+ * @param {float*} x: vector x
+ * @param {float*} y: vector y
+ * @param {float*} z: vector z
+ * @param {long long} length: the length of vectors
+ */
+void sequential_add_vectors(float* x, float* y, float* z, long long length) {
+    for ( long long i = 0; i < length; i++ ) {
+        z[i] = x[i] + y[i];
+    }
+}
+
+/**
+ * @description: validate results from sequential version and parallel version
+ * @param {float*} z: vector z
+ * @param {float*} z_parallel: vector z_parallel
+ * @param {long long} length: the length of vectors
+ */
+void validate_result(float* z, float* z_parallel, long long length){
+    for ( long long i = 0; i < length; i++ ) {
+        if ( z_parallel[i] != z[i] ){
+            std::cout << "False" << std::endl;
+            return;
+        }
+    }
+
+    std::cout << "True" << std::endl;
+}
+
+/**
+ * @description: the best time of a few runs of f, in seconds
+ */
+template <typename F>
+double best_time(const F& f, int trials) {
+    double best = 1e30;
+    for ( int trial = 0; trial < trials; trial++ ) {
+        std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+        f();
+        std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start_time;
+        best = std::min(best, duration.count());
+    }
+    return best;
+}
+
+/**
+ * @description: print the time and the traffic of an unfused and a fused version of the same computation
+ * @param {double} unfused_bytes, fused_bytes: the bytes each version reads and writes per element
+ */
+void report_fusion(const char* name, long long length, double unfused_time, double unfused_bytes, double fused_time, double fused_bytes) {
+    std::cout << name << std::endl;
+    std::cout << "unfused: " << unfused_time << " seconds, " << unfused_bytes * length / (1 << 20) << " MiB moved, "
+              << unfused_bytes * length / unfused_time / 1e9 << " GB/s" << std::endl;
+    std::cout << "fused: " << fused_time << " seconds, " << fused_bytes * length / (1 << 20) << " MiB moved, "
+              << fused_bytes * length / fused_time / 1e9 << " GB/s" << std::endl;
+    std::cout << "speedup: " << unfused_time / fused_time << std::endl;
+}
+
+/**
+ * @description: z = a * x + y - w and dot(x + y, w), one loop per operator against one fused loop
+ *               bytes are counted like STREAM, 4 per float read and 4 per float written
+ * @param {long long} length: the length of vectors
+ * @param {int} num_of_threads: the number of threads
+ */
+void expression_template_benchmark(long long length, int num_of_threads) {
+    const float a = 3;
+    const int trials = 3;
+    lazy_vector x(length, num_of_threads);
+    lazy_vector y(length, num_of_threads);
+    lazy_vector w(length, num_of_threads);
+    lazy_vector z(length, num_of_threads);
+    lazy_vector z_fused(length, num_of_threads);
+    lazy_vector t1(length, num_of_threads);
+    lazy_vector t2(length, num_of_threads);
+    random_fill_integers(x.data(), length, 0, MAX_VAL, DEFAULT_RANDOM_SEED, num_of_threads);
+    random_fill_integers(y.data(), length, 0, MAX_VAL, DEFAULT_RANDOM_SEED + 1, num_of_threads);
+    random_fill_integers(w.data(), length, 0, MAX_VAL, DEFAULT_RANDOM_SEED + 2, num_of_threads);
+
+    // three loops: read 1 write 1, read 2 write 1, read 2 write 1, against read 3 write 1
+    const double unfused_time = best_time([&]() {
+        t1 = a * x;
+        t2 = t1 + y;
+        z = t2 - w;
+    }, trials);
+    const double fused_time = best_time([&]() {
+        z_fused = a * x + y - w;
+    }, trials);
+    std::cout << "Running expression templates, length " << length << ", " << num_of_threads << " threads: " << std::endl;
+    report_fusion("z = a * x + y - w", length, unfused_time, 32, fused_time, 16);
+    validate_result(z.data(), z_fused.data(), length);
+
+    // two passes: read 2 write 1, read 2, against read 3
+    double unfused_dot = 0;
+    double fused_dot = 0;
+    const double unfused_dot_time = best_time([&]() {
+        t1 = x + y;
+        unfused_dot = dot(t1, w, num_of_threads);
+    }, trials);
+    const double fused_dot_time = best_time([&]() {
+        fused_dot = dot(x + y, w, num_of_threads);
+    }, trials);
+    report_fusion("dot(x + y, w)", length, unfused_dot_time, 20, fused_dot_time, 12);
+    std::cout << "dot product: " << fused_dot << std::endl;
+    std::cout << (unfused_dot == fused_dot ? "True" : "False") << std::endl;
+}
+
+/**
+ * @description: the bits of a double, to compare results exactly
+ */
+uint64_t double_bits(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+/**
+ * @description: sum(x) and dot(x, y) of floats in [-1, 1), plain parallel reductions against reproducible ones
+ *               the plain ones change in their last bits with the number of threads, the reproducible ones do not
+ * @param {long long} length: the length of vectors
+ * @param {int} num_of_threads: the number of threads of the timed runs
+ */
+void reproducible_reduction_benchmark(long long length, int num_of_threads) {
+    const int trials = 3;
+    const int thread_counts[] = {1, 2, 3, 4, 8, num_of_threads};
+    lazy_vector x(length, num_of_threads);
+    lazy_vector y(length, num_of_threads);
+    random_fill_uniform(x.data(), length, -1, 1, DEFAULT_RANDOM_SEED + 3, num_of_threads);
+    random_fill_uniform(y.data(), length, -1, 1, DEFAULT_RANDOM_SEED + 4, num_of_threads);
+
+    std::cout << "Running reproducible reductions, length " << length << ": " << std::endl;
+    const double plain_sum = sum(x, 1);
+    const double plain_dot = dot(x, y, 1);
+    const double exact_sum = reproducible_sum(x.data(), length, 1);
+    const double exact_dot = reproducible_dot(x.data(), y.data(), length, 1);
+    bool plain_same = true;
+    bool reproducible_same = true;
+    for ( int threads : thread_counts ) {
+        const double s = sum(x, threads);
+        const double d = dot(x, y, threads);
+        const double rs = reproducible_sum(x.data(), length, threads);
+        const double rd = reproducible_dot(x.data(), y.data(), length, threads);
+        std::cout.precision(17);
+        std::cout << threads << " threads: sum " << s << ", reproducible sum " << rs
+                  << ", dot " << d << ", reproducible dot " << rd << std::endl;
+        std::cout.precision(6);
+        plain_same = plain_same && double_bits(s) == double_bits(plain_sum) && double_bits(d) == double_bits(plain_dot);
+        reproducible_same = reproducible_same && double_bits(rs) == double_bits(exact_sum) && double_bits(rd) == double_bits(exact_dot);
+    }
+    std::cout << "plain results identical for all thread counts: " << (plain_same ? "True" : "False") << std::endl;
+    std::cout << "reproducible results identical for all thread counts: " << (reproducible_same ? "True" : "False") << std::endl;
+
+    // a product that overflows is an infinity with no error term, not inf - inf = NaN
+    const double large[] = {1e200, 1, 2};
+    bool overflow_is_inf = true;
+    for ( int threads : thread_counts ) {
+        const double overflow_dot = reproducible_dot(large, large, 3, threads);
+        overflow_is_inf = overflow_is_inf && std::isinf(overflow_dot) && overflow_dot > 0;
+    }
+    std::cout << "reproducible dot of {1e200, 1, 2} with itself is +inf: " << (overflow_is_inf ? "True" : "False") << std::endl;
+
+    // a subnormal maximum needs a scale above the largest double, which must not become an infinity
+    const double tiny[] = {1e-310, 2e-310, -5e-311};
+    bool subnormal_sum_is_right = true;
+    for ( int threads : thread_counts ) {
+        subnormal_sum_is_right = subnormal_sum_is_right && reproducible_sum(tiny, 3, threads) == (1e-310 + 2e-310) - 5e-311;
+    }
+    std::cout << "reproducible sum of {1e-310, 2e-310, -5e-311} is 2.5e-310: " << (subnormal_sum_is_right ? "True" : "False") << std::endl;
+
+    const double sum_time = best_time([&]() { sum(x, num_of_threads); }, trials);
+    const double reproducible_sum_time = best_time([&]() { reproducible_sum(x.data(), length, num_of_threads); }, trials);
+    const double dot_time = best_time([&]() { dot(x, y, num_of_threads); }, trials);
+    const double reproducible_dot_time = best_time([&]() { reproducible_dot(x.data(), y.data(), length, num_of_threads); }, trials);
+    std::cout << "sum: " << sum_time << " seconds, reproducible: " << reproducible_sum_time << " seconds, "
+              << reproducible_sum_time / sum_time << " times slower" << std::endl;
+    std::cout << "dot: " << dot_time << " seconds, reproducible: " << reproducible_dot_time << " seconds, "
+              << reproducible_dot_time / dot_time << " times slower" << std::endl;
+}
+
+
+int main() {
+
+    std::chrono::steady_clock::time_point start_time;
+    std::chrono::duration<double> duration;
+    const int num_of_threads = std::max(1u, std::thread::hardware_concurrency());
+    const double bytes = 3.0 * sizeof(float) * MATERIALIZED_LENGTH;
+
+    // whole vectors, 256 MiB each
+    float* x = new float[MATERIALIZED_LENGTH];
+    float* y = new float[MATERIALIZED_LENGTH];
+    float* z = new float[MATERIALIZED_LENGTH];
+    float* z_parallel = new float[MATERIALIZED_LENGTH];
+    random_fill_integers(x, MATERIALIZED_LENGTH, 0, MAX_VAL, DEFAULT_RANDOM_SEED, num_of_threads);
+    random_fill_integers(y, MATERIALIZED_LENGTH, 0, MAX_VAL, DEFAULT_RANDOM_SEED + 1, num_of_threads);
+    for ( long long i = 0; i < MATERIALIZED_LENGTH; i++ ) {
+        z[i] = 0;
+        z_parallel[i] = 0;
+    }
+
+    std::cout << "Running sequential version, length " << MATERIALIZED_LENGTH << ": " << std::endl;
+    start_time = std::chrono::steady_clock::now();
+    sequential_add_vectors(x, y, z, MATERIALIZED_LENGTH);
+    duration = std::chrono::steady_clock::now() - start_time;
+    std::cout << "Time: " << duration.count() << ", " << bytes / duration.count() / 1e9 << " GB/s" << std::endl;
+
+    std::cout << "Running multithreaded streaming version, " << num_of_threads << " threads: " << std::endl;
+    start_time = std::chrono::steady_clock::now();
+    parallel_add_vectors(x, y, z_parallel, MATERIALIZED_LENGTH, num_of_threads, true);
+    duration = std::chrono::steady_clock::now() - start_time;
+    const double achieved = bytes / duration.count() / 1e9;
+    std::cout << "Time: " << duration.count() << ", " << achieved << " GB/s" << std::endl;
+    validate_result(z, z_parallel, MATERIALIZED_LENGTH);
+
+    const double stream = stream_add_bandwidth(x, y, z_parallel, MATERIALIZED_LENGTH, num_of_threads, 5);
+    std::cout << "STREAM Add bandwidth: " << stream << " GB/s" << std::endl;
+    std::cout << "streaming version / STREAM Add: " << achieved / stream << std::endl;
+
+    delete[] z_parallel;
+    delete[] z;
+    delete[] y;
+    delete[] x;
+
+    expression_template_benchmark(MATERIALIZED_LENGTH, num_of_threads);
+    reproducible_reduction_benchmark(MATERIALIZED_LENGTH, num_of_threads);
+
+    // all 2^30 elements in pieces, 3 * 64 KiB per thread
+    std::cout << "Running bounded-memory version, length " << LENGTH << ": " << std::endl;
+    start_time = std::chrono::steady_clock::now();
+    chunked_add_result result = chunked_add_vectors(LENGTH, CHUNK_SIZE, num_of_threads, MAX_VAL, DEFAULT_RANDOM_SEED, false);
+    duration = std::chrono::steady_clock::now() - start_time;
+    std::cout << "Time: " << duration.count() << ", " << LENGTH / duration.count() / 1e9 << " billion elements per second, "
+              << 3 * CHUNK_SIZE * sizeof(float) * num_of_threads / 1024 << " KiB of buffers" << std::endl;
+    std::cout << "checksum: " << result.checksum << std::endl;
+    std::cout << (result.mismatches == 0 ? "True" : "False") << std::endl;
+
+    // the streaming path on pieces that are not a whole number of vectors, with the same inputs
+    std::cout << "Running bounded-memory streaming version, length " << MATERIALIZED_LENGTH << ": " << std::endl;
+    chunked_add_result streaming_result = chunked_add_vectors(MATERIALIZED_LENGTH, CHUNK_SIZE - 3, num_of_threads, MAX_VAL,
+                                                              DEFAULT_RANDOM_SEED, true);
+    chunked_add_result normal_result = chunked_add_vectors(MATERIALIZED_LENGTH, CHUNK_SIZE, 1, MAX_VAL, DEFAULT_RANDOM_SEED, false);
+    std::cout << "checksum: " << streaming_result.checksum << std::endl;
+    std::cout << (streaming_result.mismatches == 0 && streaming_result.checksum == normal_result.checksum ? "True" : "False") << std::endl;
+
+    return 0;
+}
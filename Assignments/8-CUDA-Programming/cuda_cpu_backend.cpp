@@ -0,0 +1,272 @@
+/*
+    CPU backend for CUDA kernels, so that the same kernel source runs on hosts without an NVIDIA GPU.
+
+    A kernel is launched with
+        LAUNCH_KERNEL(kernel, blocks, threads, arguments...);
+    which is kernel<<<blocks, threads>>>(arguments...) under nvcc. Compiled as C++ (g++ -x c++ file.cu), this file
+    provides __global__, __shared__, threadIdx, blockIdx, blockDim, gridDim, __syncthreads and the few runtime
+    calls the assignments use (cudaMalloc, cudaMemcpy, cudaFree, cudaSetDevice, cudaDeviceSynchronize).
+    Device memory is host memory, and a launch returns when the kernel is done.
+
+    Blocks go to one worker std::thread per core, which take the next block from an atomic counter. A block
+    always runs on one worker, so __shared__ is static thread_local: one copy per worker, reused block after block.
+
+    The threads of a block run in one of two ways:
+        - direct: a plain loop over threadIdx on the worker, with the kernel inlined into it and no switch per
+          thread. The compiler vectorizes it across threadIdx when it can follow the index arithmetic; the usual
+          int tid = blockIdx.x * blockDim.x + threadIdx.x mixes unsigned and int, and stays scalar with GCC.
+        - fibers: every thread gets its own stack (ucontext), and __syncthreads switches back to the worker,
+          which resumes the other threads in order. One round resumes every thread once, until its next barrier
+          or its end, so all threads are at the same barrier after each round.
+    Thread 0 of each block runs first, on a fiber. If it ends without calling __syncthreads, neither does any
+    other thread of the block, because CUDA requires every thread of a block to reach the same barriers, and
+    the rest of the block runs directly. Otherwise the whole block runs on fibers. A switch costs about as
+    much as a system call, so kernels with many barriers per element are much slower than on a GPU.
+*/
+
+#ifdef __CUDACC__
+
+#define LAUNCH_KERNEL(kernel, blocks, threads, ...)     kernel<<<(blocks), (threads)>>>(__VA_ARGS__)
+
+#else
+
+#include <cstdio>
+#include <cstdlib>      /* std::malloc, std::free, std::abort */
+#include <cstring>      /* std::memcpy */
+#include <atomic>
+#include <memory>       /* std::unique_ptr */
+#include <thread>
+#include <vector>
+#include <algorithm>    /* std::min, std::max */
+#include <ucontext.h>   /* getcontext, makecontext, swapcontext */
+
+#define __global__
+#define __device__
+#define __host__
+#define __shared__      static thread_local
+
+const size_t FIBER_STACK_SIZE{1 << 16};
+
+struct uint3 {
+    unsigned int x, y, z;
+};
+
+struct dim3 {
+    unsigned int x, y, z;
+    dim3(unsigned int x = 1, unsigned int y = 1, unsigned int z = 1) : x(x), y(y), z(z) {}
+};
+
+thread_local uint3 threadIdx;
+thread_local uint3 blockIdx;
+thread_local dim3 blockDim;
+thread_local dim3 gridDim;
+
+/**
+ * @description: runs the threads of one block after another on the calling worker
+ */
+class block_runner {
+
+public:
+
+    /**
+     * @description: run every thread of the current block, blockDim threads of thread_body()
+     */
+    template <typename F>
+    void run(const F& thread_body) {
+        const unsigned int n = blockDim.x * blockDim.y * blockDim.z;
+        body = &thread_body;
+        invoke = [](const void* f) { (*static_cast<const F*>(f))(); };
+        if ( fibers.size() < n ) {
+            fibers.resize(n);
+            finished.resize(n);
+            stacks.resize(n);
+        }
+
+        // thread 0 on a fiber, to find out whether the block calls __syncthreads
+        start_fiber(0);
+        resume(0);
+        if ( finished[0] ) {
+            for ( unsigned int z = 0; z < blockDim.z; z++ ) {
+                for ( unsigned int y = 0; y < blockDim.y; y++ ) {
+                    for ( unsigned int x = (y == 0 && z == 0); x < blockDim.x; x++ ) {
+                        threadIdx.x = x;
+                        threadIdx.y = y;
+                        threadIdx.z = z;
+                        thread_body();
+                    }
+                }
+            }
+            return;
+        }
+
+        // the other threads up to the first barrier, then one round per barrier
+        for ( unsigned int t = 1; t < n; t++ ) {
+            start_fiber(t);
+            resume(t);
+        }
+        bool running = true;
+        while ( running ) {
+            running = false;
+            for ( unsigned int t = 0; t < n; t++ ) {
+                if ( !finished[t] ) {
+                    resume(t);
+                    running = running || !finished[t];
+                }
+            }
+        }
+    }
+
+    /**
+     * @description: __syncthreads, suspend the current thread until the next round
+     */
+    void synchronize() {
+        if ( !in_fiber ) {
+            std::fprintf(stderr, "__syncthreads is not reached by every thread of block (%u, %u, %u)\n",
+                         blockIdx.x, blockIdx.y, blockIdx.z);
+            std::abort();
+        }
+        swapcontext(&fibers[current], &scheduler);
+    }
+
+    static thread_local block_runner* active;
+
+private:
+
+    ucontext_t scheduler;
+    std::vector<ucontext_t> fibers;
+    std::vector<char> finished;
+    std::vector<std::unique_ptr<char[]>> stacks;
+    const void* body = nullptr;
+    void (*invoke)(const void*) = nullptr;
+    unsigned int current = 0;
+    bool in_fiber = false;
+
+    static void fiber_main() {
+        block_runner* runner = active;
+        runner->invoke(runner->body);
+        runner->finished[runner->current] = 1;
+        // returning resumes the scheduler through uc_link
+    }
+
+    void start_fiber(unsigned int t) {
+        if ( !stacks[t] ) {
+            stacks[t].reset(new char[FIBER_STACK_SIZE]);
+        }
+        finished[t] = 0;
+        getcontext(&fibers[t]);
+        fibers[t].uc_stack.ss_sp = stacks[t].get();
+        fibers[t].uc_stack.ss_size = FIBER_STACK_SIZE;
+        fibers[t].uc_link = &scheduler;
+        makecontext(&fibers[t], fiber_main, 0);
+    }
+
+    void resume(unsigned int t) {
+        current = t;
+        threadIdx.x = t % blockDim.x;
+        threadIdx.y = t / blockDim.x % blockDim.y;
+        threadIdx.z = t / (blockDim.x * blockDim.y);
+        in_fiber = true;
+        swapcontext(&scheduler, &fibers[t]);
+        in_fiber = false;
+    }
+};
+
+thread_local block_runner* block_runner::active = nullptr;
+
+/**
+ * @description: wait until every thread of the block gets here
+ */
+inline void __syncthreads() {
+    block_runner::active->synchronize();
+}
+
+/**
+ * @description: run thread_body() for every thread of every block, blocks spread over the cores
+ */
+template <typename F>
+void cpu_launch(dim3 grid, dim3 block, const F& thread_body) {
+    const long long num_of_blocks = (long long)grid.x * grid.y * grid.z;
+    const int num_of_workers = (int)std::min<long long>(num_of_blocks, std::max(1u, std::thread::hardware_concurrency()));
+    std::atomic<long long> next_block{0};
+
+    auto work = [&]() {
+        block_runner runner;
+        block_runner::active = &runner;
+        gridDim = grid;
+        blockDim = block;
+        for ( long long b = next_block++; b < num_of_blocks; b = next_block++ ) {
+            blockIdx.x = (unsigned int)(b % grid.x);
+            blockIdx.y = (unsigned int)(b / grid.x % grid.y);
+            blockIdx.z = (unsigned int)(b / ((long long)grid.x * grid.y));
+            runner.run(thread_body);
+        }
+        block_runner::active = nullptr;
+    };
+
+    std::vector<std::thread> workers;
+    for ( int w = 0; w < num_of_workers; w++ ) {
+        workers.push_back(std::thread(work));
+    }
+    for ( std::thread& worker : workers ) {
+        worker.join();
+    }
+}
+
+/**
+ * @description: the CPU form of kernel<<<grid, block>>>, the kernel is a template argument so it can be inlined
+ */
+template <typename Kernel, Kernel kernel>
+struct cpu_kernel_launch {
+    dim3 grid;
+    dim3 block;
+
+    cpu_kernel_launch(dim3 grid, dim3 block) : grid(grid), block(block) {}
+
+    template <typename... Args>
+    void operator()(Args... args) const {
+        cpu_launch(grid, block, [=]() { kernel(args...); });
+    }
+};
+
+#define LAUNCH_KERNEL(kernel, blocks, threads, ...) \
+    cpu_kernel_launch<decltype(&kernel), &kernel>((blocks), (threads))(__VA_ARGS__)
+
+
+/*
+    The runtime calls used by the assignments. Device memory is host memory.
+*/
+
+enum cudaError_t { cudaSuccess = 0, cudaErrorMemoryAllocation = 2 };
+
+enum cudaMemcpyKind {
+    cudaMemcpyHostToHost = 0,
+    cudaMemcpyHostToDevice = 1,
+    cudaMemcpyDeviceToHost = 2,
+    cudaMemcpyDeviceToDevice = 3
+};
+
+inline cudaError_t cudaSetDevice(int) {
+    return cudaSuccess;
+}
+
+inline cudaError_t cudaDeviceSynchronize() {
+    return cudaSuccess;
+}
+
+template <typename T>
+cudaError_t cudaMalloc(T** pointer, size_t size) {
+    *pointer = static_cast<T*>(std::malloc(size));
+    return *pointer != nullptr || size == 0 ? cudaSuccess : cudaErrorMemoryAllocation;
+}
+
+inline cudaError_t cudaMemcpy(void* destination, const void* source, size_t size, cudaMemcpyKind) {
+    std::memcpy(destination, source, size);
+    return cudaSuccess;
+}
+
+inline cudaError_t cudaFree(void* pointer) {
+    std::free(pointer);
+    return cudaSuccess;
+}
+
+#endif
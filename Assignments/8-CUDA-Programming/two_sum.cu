@@ -1,8 +1,15 @@
 #include <iostream>
 #include <chrono>       /* time manipulation */
+#include <thread>
+
+#include "cuda_cpu_backend.cpp"
+#include "cpu_add_vectors.cpp"
+#include "../5-C++-Threads-and-Synchronization/reproducible_sum.cpp"
 
 const int LENGTH{1 << 30};
 const int MAX_VAL{1 << 4};
+const int SUM_BLOCKS{256};
+const int SUM_THREADS{256};
 
 /**
  * @description: kernel definition
@@ -20,6 +27,34 @@ __global__ void add_vectors(float* x, float* y, float* z, int length) {
 
 }
 
+/**
+ * @description: kernel definition, the sum of z per block, with a tree reduction in shared memory
+ * @param {float*} z: vector z
+ * @param {double*} block_sums: the sum of each block
+ * @param {int} length: the length of vectors
+ */
+__global__ void sum_vector(const float* z, double* block_sums, int length) {
+
+    __shared__ double partial[SUM_THREADS];
+    double sum = 0;
+    for ( int i = blockIdx.x * blockDim.x + threadIdx.x; i < length; i += blockDim.x * gridDim.x ) {
+        sum += z[i];
+    }
+    partial[threadIdx.x] = sum;
+    __syncthreads();
+
+    for ( int half = blockDim.x / 2; half > 0; half /= 2 ) {
+        if ( (int)threadIdx.x < half ) {
+            partial[threadIdx.x] += partial[threadIdx.x + half];
+        }
+        __syncthreads();
+    }
+    if ( threadIdx.x == 0 ) {
+        block_sums[blockIdx.x] = partial[0];
+    }
+
+}
+
 /**
  * @description: initialize vectors
  * @param {float*} x: vector x
@@ -27,12 +62,12 @@ __global__ void add_vectors(float* x, float* y, float* z, int length) {
  * @param {float*} z: vector z
  * @param {float*} z_from_cuda: vector z_from_cuda
  * @param {int} length: the length of vectors
+ * @param {int} num_of_threads: the number of threads filling x and y
  */
-void initialize(float* x, float* y, float* z, float* z_from_cuda, int length) {
-    srand(1);
+void initialize(float* x, float* y, float* z, float* z_from_cuda, int length, int num_of_threads) {
+    random_fill_integers(x, length, 0, MAX_VAL, DEFAULT_RANDOM_SEED, num_of_threads);
+    random_fill_integers(y, length, 0, MAX_VAL, DEFAULT_RANDOM_SEED + 1, num_of_threads);
     for ( int i = 0; i < length; i++ ) {
-        x[i] = rand() % MAX_VAL;
-        y[i] = rand() % MAX_VAL;
         z[i] = 0;
         z_from_cuda[i] = 0;
     }
@@ -89,7 +124,8 @@ int main() {
     float* h_z = new float[LENGTH];
     float* h_z_from_cuda = new float[LENGTH];
 
-    initialize(h_x, h_y, h_z, h_z_from_cuda, LENGTH);
+    const int num_of_threads = std::max(1u, std::thread::hardware_concurrency());
+    initialize(h_x, h_y, h_z, h_z_from_cuda, LENGTH, num_of_threads);
 
     std::cout << "Running sequential version: " << std::endl;
     start_time = std::chrono::steady_clock::now();
@@ -100,6 +136,17 @@ int main() {
     duration = end_time - start_time; 
     t1 = duration.count();
     std::cout << "Time: " << t1 << std::endl;
+
+    // multithreaded CPU version, into h_z_from_cuda before the cuda version overwrites it
+    std::cout << "Running multithreaded CPU version: " << std::endl;
+    start_time = std::chrono::steady_clock::now();
+
+    parallel_add_vectors(h_x, h_y, h_z_from_cuda, LENGTH, num_of_threads, true);
+
+    end_time = std::chrono::steady_clock::now();
+    duration = end_time - start_time;
+    std::cout << "Time: " << duration.count() << ", " << 3.0 * sizeof(float) * LENGTH / duration.count() / 1e9 << " GB/s" << std::endl;
+    validate_result(h_z, h_z_from_cuda, LENGTH);
    
     // cuda version
     const int threadsPerBlock = 1024;
@@ -124,7 +171,7 @@ int main() {
     cudaMemcpy(d_y, h_y, size, cudaMemcpyHostToDevice);
 
     // cuda operation
-    add_vectors<<<numOfBlocks, threadsPerBlock>>>(d_x, d_y, d_z, LENGTH);
+    LAUNCH_KERNEL(add_vectors, numOfBlocks, threadsPerBlock, d_x, d_y, d_z, LENGTH);
 
     // Copy result from device memory to host memory
     cudaMemcpy(h_z_from_cuda, d_z, size, cudaMemcpyDeviceToHost);
@@ -134,10 +181,24 @@ int main() {
     tp = duration_cuda.count();
     std::cout << "Time: " << tp << std::endl;
 
+    // checksum of z on the device, every partial sum is exact in double
+    double* d_block_sums;
+    double h_block_sums[SUM_BLOCKS];
+    cudaMalloc(&d_block_sums, SUM_BLOCKS * sizeof(double));
+    LAUNCH_KERNEL(sum_vector, SUM_BLOCKS, SUM_THREADS, d_z, d_block_sums, LENGTH);
+    cudaMemcpy(h_block_sums, d_block_sums, SUM_BLOCKS * sizeof(double), cudaMemcpyDeviceToHost);
+    double checksum_from_cuda = 0;
+    for ( int b = 0; b < SUM_BLOCKS; b++ ) {
+        checksum_from_cuda += h_block_sums[b];
+    }
+    const double checksum = reproducible_sum(h_z, LENGTH, num_of_threads);
+    std::cout << "checksum: " << checksum_from_cuda << ", " << (checksum_from_cuda == checksum ? "True" : "False") << std::endl;
+
     // free device memory
     cudaFree(d_x);
     cudaFree(d_y);
     cudaFree(d_z);
+    cudaFree(d_block_sums);
     
     // synchronize the GPU preventing premature termination
     cudaDeviceSynchronize();
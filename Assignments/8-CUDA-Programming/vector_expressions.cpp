@@ -0,0 +1,272 @@
+#include <vector>
+#include <thread>
+#include <algorithm>    /* std::min, std::max */
+#include <type_traits>  /* std::enable_if, std::is_base_of */
+
+/*
+    Lazy vector arithmetic with expression templates.
+
+    Written the usual way, z = a * x + y - w runs one loop per operator, and every loop reads its operands from
+    memory and writes a temporary vector back. Here an operator does not compute anything. It returns a small
+    object that records the operation and its operands, so a * x + y - w has the type
+        vector_difference<vector_sum<scaled_vector<vector_reference>, vector_reference>, vector_reference>
+    and element i of it is a * x[i] + y[i] - w[i], inlined by the compiler. The work happens when the expression
+    is assigned to a lazy_vector, or reduced with sum or dot:
+        - the range [0, length) is split into one contiguous range of whole cache lines per thread,
+        - every thread evaluates the whole expression element by element, in one loop with no temporaries.
+    The leaves hold plain pointers to the data, not references to the vectors, so the compiler sees a simple
+    loop over arrays and vectorizes it.
+
+    Reductions accumulate in double, in REDUCTION_LANES independent partial sums per thread, which the compiler
+    keeps in vector registers. The partial sums of all threads are then added in a fixed order, so the result
+    depends on the number of threads but not on their timing.
+
+    Operands of one expression must have the same length. An expression only holds pointers, so it must not
+    outlive its vectors; store results in a lazy_vector, not in an auto variable.
+*/
+
+const long long EXPRESSION_CACHE_LINE{16};  // elements of 4 bytes per cache line
+const int REDUCTION_LANES{16};
+
+/**
+ * @description: the base of all vector expressions, E is the derived type
+ */
+template <typename E>
+struct vector_expression {
+    const E& self() const { return static_cast<const E&>(*this); }
+};
+
+/**
+ * @description: the elements of a lazy_vector, as a leaf of an expression
+ */
+struct vector_reference : vector_expression<vector_reference> {
+    const float* data;
+    long long length;
+
+    vector_reference(const float* data, long long length) : data(data), length(length) {}
+    float operator[](long long i) const { return data[i]; }
+    long long size() const { return length; }
+};
+
+class lazy_vector;
+
+/**
+ * @description: how an operand is stored in an expression: a lazy_vector by pointer, an expression by value
+ */
+template <typename E>
+struct expression_operand {
+    using type = E;
+};
+
+template <>
+struct expression_operand<lazy_vector> {
+    using type = vector_reference;
+};
+
+/**
+ * @description: l[i] op r[i], for op one of +, -, *
+ */
+template <typename L, typename R, typename Op>
+struct vector_binary : vector_expression<vector_binary<L, R, Op>> {
+    typename expression_operand<L>::type left;
+    typename expression_operand<R>::type right;
+
+    vector_binary(const L& left, const R& right) : left(left), right(right) {}
+    float operator[](long long i) const { return Op::apply(left[i], right[i]); }
+    long long size() const { return left.size(); }
+};
+
+/**
+ * @description: a * e[i]
+ */
+template <typename E>
+struct scaled_vector : vector_expression<scaled_vector<E>> {
+    float a;
+    typename expression_operand<E>::type operand;
+
+    scaled_vector(float a, const E& operand) : a(a), operand(operand) {}
+    float operator[](long long i) const { return a * operand[i]; }
+    long long size() const { return operand.size(); }
+};
+
+struct plus_operation {
+    static float apply(float l, float r) { return l + r; }
+};
+
+struct minus_operation {
+    static float apply(float l, float r) { return l - r; }
+};
+
+struct multiplies_operation {
+    static float apply(float l, float r) { return l * r; }
+};
+
+template <typename L, typename R>
+using vector_sum = vector_binary<L, R, plus_operation>;
+template <typename L, typename R>
+using vector_difference = vector_binary<L, R, minus_operation>;
+template <typename L, typename R>
+using vector_product = vector_binary<L, R, multiplies_operation>;
+
+/**
+ * @description: run f(t, first, last) for t in [0, num_of_threads), on contiguous ranges of whole cache lines
+ */
+template <typename F>
+void for_each_thread_range(long long length, int num_of_threads, const F& f) {
+    const long long lines = (length + EXPRESSION_CACHE_LINE - 1) / EXPRESSION_CACHE_LINE;
+    if ( num_of_threads <= 1 ) {
+        f(0, 0LL, length);
+        return;
+    }
+    std::vector<std::thread> threads;
+    for ( int t = 0; t < num_of_threads; t++ ) {
+        const long long first = std::min(length, lines * t / num_of_threads * EXPRESSION_CACHE_LINE);
+        const long long last = std::min(length, lines * (t + 1) / num_of_threads * EXPRESSION_CACHE_LINE);
+        threads.push_back(std::thread(f, t, first, last));
+    }
+    for ( std::thread& thread : threads ) {
+        thread.join();
+    }
+}
+
+/**
+ * @description: a float vector that evaluates expressions assigned to it in one fused, multithreaded loop
+ */
+class lazy_vector : public vector_expression<lazy_vector> {
+
+public:
+
+    /**
+     * @description: constructor
+     * @param {long long} length: the length of the vector
+     * @param {int} num_of_threads: the number of threads that evaluate expressions assigned to it
+     */
+    lazy_vector(long long length, int num_of_threads) :
+        elements(length),
+        num_of_threads(std::max(1, num_of_threads)) {}
+
+    /**
+     * @description: evaluate an expression into this vector, in one pass
+     */
+    template <typename E>
+    lazy_vector& operator=(const vector_expression<E>& expression) {
+        const typename expression_operand<E>::type e(expression.self());
+        float* out = elements.data();
+        for_each_thread_range(size(), num_of_threads, [e, out](int, long long first, long long last) {
+            for ( long long i = first; i < last; i++ ) {
+                out[i] = e[i];
+            }
+        });
+        return *this;
+    }
+
+    lazy_vector& operator=(const lazy_vector& other) {
+        return *this = vector_reference(other.data(), other.size());
+    }
+
+    operator vector_reference() const { return vector_reference(data(), size()); }
+    float operator[](long long i) const { return elements[i]; }
+    float& operator[](long long i) { return elements[i]; }
+    long long size() const { return (long long)elements.size(); }
+    float* data() { return elements.data(); }
+    const float* data() const { return elements.data(); }
+
+private:
+
+    std::vector<float> elements;
+    int num_of_threads;
+};
+
+
+template <typename E>
+using is_vector_expression = std::is_base_of<vector_expression<E>, E>;
+
+/**
+ * @description: the elementwise sum l[i] + r[i]
+ */
+template <typename L, typename R>
+typename std::enable_if<is_vector_expression<L>::value && is_vector_expression<R>::value, vector_sum<L, R>>::type
+operator+(const L& left, const R& right) {
+    return vector_sum<L, R>(left, right);
+}
+
+/**
+ * @description: the elementwise difference l[i] - r[i]
+ */
+template <typename L, typename R>
+typename std::enable_if<is_vector_expression<L>::value && is_vector_expression<R>::value, vector_difference<L, R>>::type
+operator-(const L& left, const R& right) {
+    return vector_difference<L, R>(left, right);
+}
+
+/**
+ * @description: the elementwise product l[i] * r[i]
+ */
+template <typename L, typename R>
+typename std::enable_if<is_vector_expression<L>::value && is_vector_expression<R>::value, vector_product<L, R>>::type
+operator*(const L& left, const R& right) {
+    return vector_product<L, R>(left, right);
+}
+
+/**
+ * @description: the scaled vector a * e[i]
+ */
+template <typename E>
+typename std::enable_if<is_vector_expression<E>::value, scaled_vector<E>>::type
+operator*(float a, const E& operand) {
+    return scaled_vector<E>(a, operand);
+}
+
+
+/**
+ * @description: the sum of term(i) for i in [0, length), accumulated in double
+ * @param {int} num_of_threads: the number of threads
+ */
+template <typename F>
+double reduce_terms(long long length, int num_of_threads, const F& term) {
+    std::vector<double> partial_sums((size_t)std::max(1, num_of_threads) * REDUCTION_LANES, 0);
+    double* partial = partial_sums.data();
+
+    for_each_thread_range(length, num_of_threads, [term, partial](int t, long long first, long long last) {
+        // independent lanes, so the loop runs on vector registers without reassociating a single sum
+        double lanes[REDUCTION_LANES] = {0};
+        long long i = first;
+        for ( ; i + REDUCTION_LANES <= last; i += REDUCTION_LANES ) {
+            for ( int k = 0; k < REDUCTION_LANES; k++ ) {
+                lanes[k] += term(i + k);
+            }
+        }
+        for ( int k = 0; i < last; i++, k++ ) {
+            lanes[k] += term(i);
+        }
+        std::copy(lanes, lanes + REDUCTION_LANES, partial + (long long)t * REDUCTION_LANES);
+    });
+
+    double result = 0;
+    for ( double value : partial_sums ) {
+        result += value;
+    }
+    return result;
+}
+
+/**
+ * @description: the sum of the elements of an expression, in one fused pass
+ * @param {int} num_of_threads: the number of threads
+ * @return {double} the sum, accumulated in double
+ */
+template <typename E>
+double sum(const vector_expression<E>& expression, int num_of_threads) {
+    const typename expression_operand<E>::type e(expression.self());
+    return reduce_terms(e.size(), num_of_threads, [e](long long i) { return (double)e[i]; });
+}
+
+/**
+ * @description: the dot product of two expressions, in one fused pass, with the products in double
+ * @param {int} num_of_threads: the number of threads
+ */
+template <typename L, typename R>
+double dot(const vector_expression<L>& left, const vector_expression<R>& right, int num_of_threads) {
+    const typename expression_operand<L>::type l(left.self());
+    const typename expression_operand<R>::type r(right.self());
+    return reduce_terms(l.size(), num_of_threads, [l, r](long long i) { return (double)l[i] * r[i]; });
+}
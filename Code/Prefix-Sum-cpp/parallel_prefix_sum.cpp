@@ -0,0 +1,307 @@
+//
+//  parallel_prefix_sum.cpp
+//  PrefixSum
+//
+//  Created by Amittai Aviram on 10/13/20.
+//  Copyright © 2020 Amittai Aviram. All rights reserved.
+//
+
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../../Assignments/5-C++-Threads-and-Synchronization/counter_rng.cpp"
+
+
+/**
+ @file parallel_prefix_sum.cpp
+ The ParallelPrefixSum demonstration class and the generic parallel scan engine built from the same algorithm,
+ for use by the other programs in this directory.
+ @author Amittai Aviram
+ @date 2020-10-13
+ */
+
+/**
+ Demonstration of the sequential version and a parallel version of the Prefix Sum algorithm.
+ */
+class ParallelPrefixSum{
+    
+public:
+    
+    /**
+     Constructor.
+     @param num_nums Size of input sequence of random integers in the range [0, 10), generated in parallel from the
+     counter-based stream of DEFAULT_RANDOM_SEED, so the sequence does not depend on num_threads.
+     @param num_threads Number of concurrent threads used to divide up the work of computing the prefix sum.
+     */
+    ParallelPrefixSum(uint32_t num_nums, uint32_t num_threads) :
+    num_nums{num_nums},
+    num_threads{num_threads},
+    nums(num_nums)
+    {
+        random_fill_integers(nums.data(), num_nums, 0, 10, DEFAULT_RANDOM_SEED, static_cast<int>(num_threads));
+        check_nums = nums;
+        for (uint32_t i = 0; i < num_threads - 1; ++i) {
+            partial_sums.push_back(-1);
+            mutexes.emplace_back(new std::mutex());
+            condition_variables.emplace_back(new std::condition_variable());
+        }
+    }
+    
+    /**
+     Constructor for a given input sequence, so that the class can serve as the reference for other prefix sum code.
+     @param input Input sequence of non-negative integers, copied into both nums and check_nums.
+     @param num_threads Number of concurrent threads, at most input.size().
+     */
+    ParallelPrefixSum(const std::vector<int64_t>& input, uint32_t num_threads) :
+    num_threads{num_threads},
+    num_nums{static_cast<uint32_t>(input.size())},
+    nums(input),
+    check_nums(input)
+    {
+        for (uint32_t i = 0; i < num_threads - 1; ++i) {
+            partial_sums.push_back(-1);
+            mutexes.emplace_back(new std::mutex());
+            condition_variables.emplace_back(new std::condition_variable());
+        }
+    }
+    
+    /**
+     Run the sequential algorithm in place on the check_nums vector, which is a copy of the nums vector.
+     */
+    void run_sequential() {
+        start = std::chrono::high_resolution_clock::now();
+        prefix_sum(check_nums, 0, check_nums.size());
+        end = std::chrono::high_resolution_clock::now();
+    }
+    
+    /**
+     Run the parallel algorithm.  Create num_thread threads, assign a portion of the input sequence ot each thread,
+     and compute the prefix sum.  This computation is in place and changes the contents of the nums sequence.
+     */
+    void run_parallel() {
+        start = std::chrono::high_resolution_clock::now();
+        std::vector<std::thread> threads;
+        for (uint32_t pid = 0; pid < num_threads; ++pid) {
+            threads.emplace_back([this, pid]{this->worker(pid);});
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        end = std::chrono::high_resolution_clock::now();
+    }
+    
+    /**
+     Computes the time interval between start and end as a floating-point number.
+     @return Value in seconds of the time interval between start and end, with a fractional part.
+     */
+    double get_time() {
+        std::chrono::duration<double> elapsed = end - start;
+        return elapsed.count();
+    }
+
+    /**
+     Report whether the parallel version of the algorithm puts out the same results as the sequential version.
+     Returns true if the results are equal and false otherwise.
+     */
+    bool verify() {
+        for (uint64_t i = 0; i < num_nums; ++i) {
+            if (nums[i] != check_nums[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    /**
+     The sequence of numbers in its current state, which may be before or after the prefix sum computation changes it.
+     */
+    const std::vector<int64_t>& get_nums() const {
+        return nums;
+    }
+    
+    /**
+     Print the sequence of random numbers in its current state, which may be before or after the prefix sum computation changes it.
+     */
+    void print_nums() {
+        for (auto num : nums) {
+            std::cout << num << " ";
+        }
+        std::cout << std::endl;
+    }
+    
+private:
+    
+    void prefix_sum(std::vector<int64_t>& nums, uint64_t start, uint64_t end) {
+        for (uint64_t i = start + 1; i < end; ++i) {
+            nums[i] += nums[i - 1];
+        }
+    }
+    
+    void worker(uint32_t pid) {
+        uint64_t chunk = num_nums / num_threads;
+        uint64_t start = pid * chunk;
+        uint64_t end = start + chunk;
+        if (pid == num_threads - 1) {
+            end = num_nums;
+        }
+        prefix_sum(nums, start, end);
+        int64_t carried_sum = 0;
+        if (pid > 0) {
+//            std::unique_lock<std::mutex> lock(mutex);
+            std::unique_lock<std::mutex> lock(*(mutexes[pid - 1]));
+//            condition_variable.wait(lock, [&]{return partial_sums[pid - 1] >= 0;});
+            condition_variables[pid - 1]->wait(lock, [&]{return partial_sums[pid - 1] >= 0;});
+            carried_sum += partial_sums[pid - 1];
+        }
+        if (pid < num_threads - 1) {
+            std::unique_lock<std::mutex> lock(*(mutexes[pid]));
+            partial_sums[pid] = carried_sum + nums[end - 1];
+            lock.unlock();
+            condition_variables[pid]->notify_one();
+        }
+        if (pid > 0) {
+            for (uint64_t i = start; i < end; ++i) {
+                nums[i] += carried_sum;
+            }
+        }
+    }
+    
+    const uint32_t num_threads;
+    const uint32_t num_nums;
+    std::vector<int64_t> nums;
+    std::vector<int64_t> check_nums;
+    std::vector<int64_t> partial_sums;
+    std::vector<std::unique_ptr<std::mutex>> mutexes;
+    std::vector<std::unique_ptr<std::condition_variable>> condition_variables;
+    std::chrono::time_point<std::chrono::high_resolution_clock> start;
+    std::chrono::time_point<std::chrono::high_resolution_clock> end;
+};
+
+
+/**
+ Splits num_items items among num_threads threads.  The last thread takes the remainder.
+ @param pid Index of the thread.
+ @param num_items Number of items.
+ @param num_threads Number of threads.
+ @return Half-open range [first, second) of the thread's chunk.
+ */
+std::pair<uint64_t, uint64_t> chunk_range(uint32_t pid, uint64_t num_items, uint32_t num_threads) {
+    const uint64_t chunk = num_items / num_threads;
+    const uint64_t start = pid * chunk;
+    const uint64_t end = (pid == num_threads - 1) ? num_items : start + chunk;
+    return {start, end};
+}
+
+/**
+ Runs worker(pid) on num_threads threads and waits for all of them.
+ */
+template <typename Worker>
+void run_workers(uint32_t num_threads, Worker worker) {
+    if (num_threads == 1) {
+        worker(0);
+        return;
+    }
+    std::vector<std::thread> threads;
+    for (uint32_t pid = 0; pid < num_threads; ++pid) {
+        threads.emplace_back(worker, pid);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+/**
+ Number of threads to use for num_items items: never more threads than items and never fewer than one.
+ */
+uint32_t clamp_num_threads(uint64_t num_items, uint32_t num_threads) {
+    if (num_threads == 0) {
+        num_threads = 1;
+    }
+    if (num_items < num_threads) {
+        num_threads = num_items == 0 ? 1 : static_cast<uint32_t>(num_items);
+    }
+    return num_threads;
+}
+
+/**
+ Computes the time elapsed since start.
+ @return Value in seconds, with a fractional part.
+ */
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+/**
+ Generic parallel prefix sum over an arbitrary buffer, using the same algorithm as ParallelPrefixSum::run_parallel:
+ each thread scans its own chunk, waits for the running total of the chunks before it, publishes its own running total
+ to the next thread, and then adds the carried sum to its chunk.  The computation is in place.
+ @param nums Buffer of num_nums elements, overwritten with its prefix sum.
+ @param num_nums Number of elements in nums.
+ @param num_threads Number of concurrent threads; chunks are never smaller than one element.
+ @param exclusive If true, element i receives the sum of elements [0, i) instead of [0, i].
+ @return Sum of all of the input elements.
+ */
+template <typename T>
+T parallel_prefix_sum(T* nums, uint64_t num_nums, uint32_t num_threads, bool exclusive = false) {
+    if (num_nums == 0) {
+        return T{};
+    }
+    num_threads = clamp_num_threads(num_nums, num_threads);
+    std::vector<T> partial_sums(num_threads, T{});
+    std::vector<char> ready(num_threads, 0);
+    std::vector<std::unique_ptr<std::mutex>> mutexes;
+    std::vector<std::unique_ptr<std::condition_variable>> condition_variables;
+    for (uint32_t i = 0; i < num_threads; ++i) {
+        mutexes.emplace_back(new std::mutex());
+        condition_variables.emplace_back(new std::condition_variable());
+    }
+    
+    auto worker = [&](uint32_t pid) {
+        const auto range = chunk_range(pid, num_nums, num_threads);
+        const uint64_t start = range.first;
+        const uint64_t end = range.second;
+        T local_sum{};
+        if (exclusive) {
+            for (uint64_t i = start; i < end; ++i) {
+                T num = nums[i];
+                nums[i] = local_sum;
+                local_sum += num;
+            }
+        }
+        else {
+            for (uint64_t i = start; i < end; ++i) {
+                local_sum += nums[i];
+                nums[i] = local_sum;
+            }
+        }
+        T carried_sum{};
+        if (pid > 0) {
+            std::unique_lock<std::mutex> lock(*(mutexes[pid - 1]));
+            condition_variables[pid - 1]->wait(lock, [&]{return ready[pid - 1] != 0;});
+            carried_sum = partial_sums[pid - 1];
+        }
+        {
+            std::unique_lock<std::mutex> lock(*(mutexes[pid]));
+            partial_sums[pid] = carried_sum + local_sum;
+            ready[pid] = 1;
+        }
+        condition_variables[pid]->notify_one();
+        if (pid > 0) {
+            for (uint64_t i = start; i < end; ++i) {
+                nums[i] += carried_sum;
+            }
+        }
+    };
+    
+    run_workers(num_threads, worker);
+    return partial_sums[num_threads - 1];
+}
@@ -0,0 +1,349 @@
+//
+//  radix_sort.cpp
+//  PrefixSum
+//
+//  Parallel LSD radix sort and stream compaction built on parallel_prefix_sum.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#if __has_include(<execution>)
+#include <execution>
+#endif
+
+#include "parallel_prefix_sum.cpp"
+
+
+/**
+ @file radix_sort.cpp
+ Applications of the parallel prefix sum: a parallel least-significant-digit radix sort of 32- and 64-bit keys with
+ payloads, and a parallel copy_if and stable partition.  All of them follow the same three steps: each thread counts
+ over its chunk of the input, an exclusive scan of the counts gives every thread the offsets to write at, and each
+ thread scatters its chunk.
+
+ Compile with
+ @code
+ g++ -std=c++17 -O3 -march=native -pthread radix_sort.cpp -o radix_sort.exe -ltbb
+ @endcode
+ (-ltbb is needed only for the std::execution::par baseline.)
+ */
+
+/**
+ Number of bits in one radix digit.
+ */
+const uint32_t RADIX_BITS = 8;
+
+/**
+ Number of distinct digit values.
+ */
+const uint32_t RADIX = 1 << RADIX_BITS;
+
+/**
+ Number of keys staged per digit in a thread's write-combining buffer before they are flushed to their destination.
+ Sixteen 32-bit keys fill one 64-byte cache line.
+ */
+const uint32_t WC_SIZE = 16;
+
+
+/**
+ Sorts keys in ascending order and permutes values the same way.  The sort is stable.
+ Each pass over one 8-bit digit:
+ - every thread builds the digit histogram of its chunk into a digit-major table, so that entry (digit, thread) sits
+   at digit * num_threads + thread,
+ - an exclusive parallel_prefix_sum over that table turns each entry into the first output position of that thread's
+   keys with that digit,
+ - every thread scatters its chunk through per-digit write-combining buffers, so that the output is written a cache
+   line at a time instead of one key at a time to 256 different places.
+ Passes in which every key has the same digit are skipped.
+ @param keys Unsigned 32- or 64-bit keys, sorted in place.
+ @param values Payloads, one per key, permuted in place.
+ @param num_threads Number of concurrent threads.
+ */
+template <typename Key, typename Value>
+void parallel_radix_sort(std::vector<Key>& keys, std::vector<Value>& values, uint32_t num_threads) {
+    static_assert(std::is_unsigned<Key>::value, "parallel_radix_sort requires unsigned keys");
+    const uint64_t num_keys = keys.size();
+    if (num_keys < 2) {
+        return;
+    }
+    num_threads = clamp_num_threads(num_keys, num_threads);
+
+    std::vector<Key> keys_buffer(num_keys);
+    std::vector<Value> values_buffer(num_keys);
+    Key* keys_in = keys.data();
+    Value* values_in = values.data();
+    Key* keys_out = keys_buffer.data();
+    Value* values_out = values_buffer.data();
+    std::vector<uint64_t> counts(RADIX * num_threads);
+
+    for (uint32_t shift = 0; shift < 8 * sizeof(Key); shift += RADIX_BITS) {
+        run_workers(num_threads, [&](uint32_t pid) {
+            uint64_t local_counts[RADIX] = {0};
+            const auto range = chunk_range(pid, num_keys, num_threads);
+            for (uint64_t i = range.first; i < range.second; ++i) {
+                ++local_counts[(keys_in[i] >> shift) & (RADIX - 1)];
+            }
+            for (uint32_t digit = 0; digit < RADIX; ++digit) {
+                counts[digit * num_threads + pid] = local_counts[digit];
+            }
+        });
+
+        bool trivial_pass = false;
+        for (uint32_t digit = 0; digit < RADIX && !trivial_pass; ++digit) {
+            uint64_t digit_count = 0;
+            for (uint32_t pid = 0; pid < num_threads; ++pid) {
+                digit_count += counts[digit * num_threads + pid];
+            }
+            trivial_pass = digit_count == num_keys;
+        }
+        if (trivial_pass) {
+            continue;
+        }
+
+        parallel_prefix_sum(counts.data(), counts.size(), num_threads, true);
+
+        run_workers(num_threads, [&](uint32_t pid) {
+            uint64_t offsets[RADIX];
+            uint32_t fill[RADIX] = {0};
+            std::vector<Key> wc_keys(RADIX * WC_SIZE);
+            std::vector<Value> wc_values(RADIX * WC_SIZE);
+            for (uint32_t digit = 0; digit < RADIX; ++digit) {
+                offsets[digit] = counts[digit * num_threads + pid];
+            }
+            const auto range = chunk_range(pid, num_keys, num_threads);
+            for (uint64_t i = range.first; i < range.second; ++i) {
+                const Key key = keys_in[i];
+                const uint32_t digit = (key >> shift) & (RADIX - 1);
+                const uint32_t slot = digit * WC_SIZE + fill[digit];
+                wc_keys[slot] = key;
+                wc_values[slot] = values_in[i];
+                if (++fill[digit] == WC_SIZE) {
+                    std::copy(&wc_keys[digit * WC_SIZE], &wc_keys[digit * WC_SIZE] + WC_SIZE, keys_out + offsets[digit]);
+                    std::copy(&wc_values[digit * WC_SIZE], &wc_values[digit * WC_SIZE] + WC_SIZE, values_out + offsets[digit]);
+                    offsets[digit] += WC_SIZE;
+                    fill[digit] = 0;
+                }
+            }
+            for (uint32_t digit = 0; digit < RADIX; ++digit) {
+                std::copy(&wc_keys[digit * WC_SIZE], &wc_keys[digit * WC_SIZE] + fill[digit], keys_out + offsets[digit]);
+                std::copy(&wc_values[digit * WC_SIZE], &wc_values[digit * WC_SIZE] + fill[digit], values_out + offsets[digit]);
+            }
+        });
+
+        std::swap(keys_in, keys_out);
+        std::swap(values_in, values_out);
+    }
+
+    if (keys_in != keys.data()) {
+        keys.swap(keys_buffer);
+        values.swap(values_buffer);
+    }
+}
+
+
+/**
+ Copies the elements of input that satisfy pred into output, preserving their order.
+ Each thread counts the matches in its chunk, an exclusive parallel_prefix_sum of the counts gives each thread its
+ first output position, and each thread then copies its matches.
+ @param input Input sequence.
+ @param output Resized to the number of matches and filled with them.
+ @param pred Unary predicate, called twice per element.
+ @param num_threads Number of concurrent threads.
+ @return Number of elements copied.
+ */
+template <typename T, typename Predicate>
+uint64_t parallel_copy_if(const std::vector<T>& input, std::vector<T>& output, Predicate pred, uint32_t num_threads) {
+    const uint64_t num_items = input.size();
+    num_threads = clamp_num_threads(num_items, num_threads);
+    std::vector<uint64_t> counts(num_threads);
+
+    run_workers(num_threads, [&](uint32_t pid) {
+        const auto range = chunk_range(pid, num_items, num_threads);
+        uint64_t count = 0;
+        for (uint64_t i = range.first; i < range.second; ++i) {
+            count += pred(input[i]) ? 1 : 0;
+        }
+        counts[pid] = count;
+    });
+
+    const uint64_t num_selected = parallel_prefix_sum(counts.data(), counts.size(), num_threads, true);
+    output.resize(num_selected);
+
+    run_workers(num_threads, [&](uint32_t pid) {
+        const auto range = chunk_range(pid, num_items, num_threads);
+        uint64_t offset = counts[pid];
+        for (uint64_t i = range.first; i < range.second; ++i) {
+            if (pred(input[i])) {
+                output[offset++] = input[i];
+            }
+        }
+    });
+    return num_selected;
+}
+
+/**
+ Stable partition of input into output: the elements that satisfy pred come first, followed by the ones that do not,
+ each group in its original order.  Uses the same count, scan and scatter steps as parallel_copy_if, with a table of
+ (true, false) counts per thread laid out so that a single exclusive scan places all the false elements after all the
+ true ones.
+ @param input Input sequence.
+ @param output Resized to input.size() and filled with the partitioned sequence.
+ @param pred Unary predicate, called twice per element.
+ @param num_threads Number of concurrent threads.
+ @return Number of elements that satisfy pred, which is also the index of the partition point in output.
+ */
+template <typename T, typename Predicate>
+uint64_t parallel_partition(const std::vector<T>& input, std::vector<T>& output, Predicate pred, uint32_t num_threads) {
+    const uint64_t num_items = input.size();
+    num_threads = clamp_num_threads(num_items, num_threads);
+    std::vector<uint64_t> counts(2 * num_threads);
+
+    run_workers(num_threads, [&](uint32_t pid) {
+        const auto range = chunk_range(pid, num_items, num_threads);
+        uint64_t count = 0;
+        for (uint64_t i = range.first; i < range.second; ++i) {
+            count += pred(input[i]) ? 1 : 0;
+        }
+        counts[pid] = count;
+        counts[num_threads + pid] = (range.second - range.first) - count;
+    });
+
+    parallel_prefix_sum(counts.data(), counts.size(), num_threads, true);
+    const uint64_t num_selected = counts[num_threads];
+    output.resize(num_items);
+
+    run_workers(num_threads, [&](uint32_t pid) {
+        const auto range = chunk_range(pid, num_items, num_threads);
+        uint64_t true_offset = counts[pid];
+        uint64_t false_offset = counts[num_threads + pid];
+        for (uint64_t i = range.first; i < range.second; ++i) {
+            if (pred(input[i])) {
+                output[true_offset++] = input[i];
+            }
+            else {
+                output[false_offset++] = input[i];
+            }
+        }
+    });
+    return num_selected;
+}
+
+
+/**
+ Sorts num_keys random key/payload pairs with parallel_radix_sort, std::sort and, when the standard library provides
+ it, std::sort(std::execution::par, ...), and checks that the radix sort matches std::stable_sort.
+ */
+template <typename Key>
+void benchmark_sort(uint64_t num_keys, uint32_t num_threads) {
+    std::vector<Key> keys(num_keys);
+    std::vector<uint32_t> values(num_keys);
+    const uint64_t key = random_key(DEFAULT_RANDOM_SEED);
+    parallel_fill_ranges(num_keys, num_threads, [&](long long first, long long last) {
+        for (long long i = first; i < last; ++i) {
+            keys[i] = static_cast<Key>(random_bits(key, i));
+            values[i] = static_cast<uint32_t>(i);
+        }
+    });
+    std::vector<std::pair<Key, uint32_t>> pairs(num_keys);
+    for (uint64_t i = 0; i < num_keys; ++i) {
+        pairs[i] = {keys[i], values[i]};
+    }
+    auto key_less = [](const std::pair<Key, uint32_t>& a, const std::pair<Key, uint32_t>& b) {
+        return a.first < b.first;
+    };
+
+    std::cout << "Sorting " << num_keys << " " << 8 * sizeof(Key) << "-bit keys with 32-bit payloads." << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    parallel_radix_sort(keys, values, num_threads);
+    const double radix_time = seconds_since(start);
+    std::cout << "Parallel radix sort: " << radix_time << " seconds." << std::endl;
+
+    auto sorted_pairs = pairs;
+    start = std::chrono::steady_clock::now();
+    std::sort(sorted_pairs.begin(), sorted_pairs.end(), key_less);
+    const double sort_time = seconds_since(start);
+    std::cout << "std::sort: " << sort_time << " seconds." << std::endl;
+
+#if defined(__cpp_lib_parallel_algorithm)
+    sorted_pairs = pairs;
+    start = std::chrono::steady_clock::now();
+    std::sort(std::execution::par, sorted_pairs.begin(), sorted_pairs.end(), key_less);
+    const double par_sort_time = seconds_since(start);
+    std::cout << "std::sort(std::execution::par): " << par_sort_time << " seconds." << std::endl;
+#else
+    std::cout << "std::sort(std::execution::par): not available in this standard library." << std::endl;
+#endif
+
+    std::stable_sort(pairs.begin(), pairs.end(), key_less);
+    bool correct = true;
+    for (uint64_t i = 0; i < num_keys && correct; ++i) {
+        correct = keys[i] == pairs[i].first && values[i] == pairs[i].second;
+    }
+    std::cout << "Results are " << (correct ? "" : "in") << "correct." << std::endl;
+    std::cout << "Speedup over std::sort: " << sort_time / radix_time << "." << std::endl;
+    std::cout << "============================================" << std::endl;
+}
+
+/**
+ Runs parallel_copy_if and parallel_partition on random integers and checks them against std::copy_if and
+ std::stable_partition.
+ */
+void benchmark_filter(uint64_t num_nums, uint32_t num_threads) {
+    std::vector<int32_t> nums(num_nums);
+    random_fill_integers(nums.data(), num_nums, 0, 1000, DEFAULT_RANDOM_SEED + 1, num_threads);
+    auto is_small = [](int32_t num) { return num < 300; };
+
+    std::cout << "Filtering " << num_nums << " integers." << std::endl;
+
+    std::vector<int32_t> selected;
+    auto start = std::chrono::steady_clock::now();
+    parallel_copy_if(nums, selected, is_small, num_threads);
+    std::cout << "Parallel copy_if: " << seconds_since(start) << " seconds." << std::endl;
+
+    std::vector<int32_t> check_selected;
+    start = std::chrono::steady_clock::now();
+    std::copy_if(nums.begin(), nums.end(), std::back_inserter(check_selected), is_small);
+    std::cout << "std::copy_if: " << seconds_since(start) << " seconds." << std::endl;
+    std::cout << "copy_if results are " << (selected == check_selected ? "" : "in") << "correct." << std::endl;
+
+    std::vector<int32_t> partitioned;
+    start = std::chrono::steady_clock::now();
+    const uint64_t partition_point = parallel_partition(nums, partitioned, is_small, num_threads);
+    std::cout << "Parallel partition: " << seconds_since(start) << " seconds." << std::endl;
+
+    std::vector<int32_t> check_partitioned = nums;
+    start = std::chrono::steady_clock::now();
+    auto check_point = std::stable_partition(check_partitioned.begin(), check_partitioned.end(), is_small);
+    std::cout << "std::stable_partition: " << seconds_since(start) << " seconds." << std::endl;
+    const bool correct = partitioned == check_partitioned
+        && partition_point == static_cast<uint64_t>(check_point - check_partitioned.begin());
+    std::cout << "partition results are " << (correct ? "" : "in") << "correct." << std::endl;
+    std::cout << "============================================" << std::endl;
+}
+
+
+/**
+ Usage: radix_sort.exe [log2 of the input size] [number of threads]
+ - Sort random 32-bit and 64-bit keys with payloads and compare against the standard library sorts.
+ - Filter and partition random integers and compare against the standard library algorithms.
+ */
+int main(int argc, const char * argv[]) {
+    const uint32_t log_num_keys = argc > 1 ? static_cast<uint32_t>(std::stoul(argv[1])) : 24;
+    const uint32_t num_threads = argc > 2 ? static_cast<uint32_t>(std::stoul(argv[2]))
+                                          : std::max(1u, std::thread::hardware_concurrency());
+    const uint64_t num_keys = uint64_t(1) << log_num_keys;
+    std::cout << "number of threads: " << num_threads << std::endl;
+    benchmark_sort<uint32_t>(num_keys, num_threads);
+    benchmark_sort<uint64_t>(num_keys, num_threads);
+    benchmark_filter(num_keys, num_threads);
+    return 0;
+}
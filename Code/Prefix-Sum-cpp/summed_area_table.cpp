@@ -0,0 +1,522 @@
+//
+//  summed_area_table.cpp
+//  PrefixSum
+//
+//  Two-dimensional prefix sums and rectangle-sum queries built on parallel_prefix_sum.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "parallel_prefix_sum.cpp"
+
+
+/**
+ @file summed_area_table.cpp
+ Rectangle-sum queries over a two-dimensional grid of integers, in two forms:
+ - SummedAreaTable, a static 2D prefix sum built in parallel with O(1) queries,
+ - FenwickTree2D, a binary indexed tree for workloads that interleave point updates with queries,
+   at O(log(rows) * log(cols)) per operation.
+ Both answer batches of queries across threads.  ParallelPrefixSum, applied to every row and then to every column,
+ is the correctness reference.
+
+ Compile with
+ @code
+ g++ -std=c++17 -O3 -march=native -pthread summed_area_table.cpp -o summed_area_table.exe
+ @endcode
+ */
+
+/**
+ Number of columns in one tile of the column pass.  Two rows of a 256-column tile of int64_t take 4 KiB, so the row
+ being updated and the row above it both stay in the L1 cache while a thread sweeps down its tile.
+ */
+const uint32_t TILE_COLS = 256;
+
+/**
+ Number of queries per thread below which a batch uses fewer threads.  A Fenwick query on a 2048 x 2048 grid takes
+ about 0.2 microseconds, so 1024 of them take several times as long as starting and joining a thread.
+ */
+const uint32_t QUERY_GRAIN = 1024;
+
+
+/**
+ Half-open rectangle [row_begin, row_end) x [col_begin, col_end) of grid cells.
+ */
+struct Rectangle {
+    uint32_t row_begin;
+    uint32_t col_begin;
+    uint32_t row_end;
+    uint32_t col_end;
+};
+
+/**
+ Answers every rectangle in rects with index.query and stores the sums in the same order.
+ The rectangles are split into contiguous chunks, one per thread, with at least QUERY_GRAIN rectangles per thread, so a
+ short batch is answered on the calling thread.
+ @param index Any object with an int64_t query(const Rectangle&) const member function.
+ @param rects Rectangles to sum.
+ @param sums Resized to rects.size() and filled with the sums.
+ @param num_threads Number of concurrent threads.
+ */
+template <typename Index>
+void parallel_query_batch(const Index& index, const std::vector<Rectangle>& rects, std::vector<int64_t>& sums,
+                          uint32_t num_threads) {
+    sums.resize(rects.size());
+    if (rects.empty()) {
+        return;
+    }
+    num_threads = clamp_num_threads(rects.size() / QUERY_GRAIN, num_threads);
+    run_workers(num_threads, [&](uint32_t pid) {
+        const auto range = chunk_range(pid, rects.size(), num_threads);
+        for (uint64_t i = range.first; i < range.second; ++i) {
+            sums[i] = index.query(rects[i]);
+        }
+    });
+}
+
+
+/**
+ Static two-dimensional prefix sum of a row-major grid.
+ The table has one extra row and column of zeros at the top and left, so that entry (i, j) holds the sum of the
+ rectangle [0, i) x [0, j) and every rectangle query is four lookups without any bounds tests.
+ */
+class SummedAreaTable {
+
+public:
+
+    /**
+     Constructor.  Builds the table in two passes:
+     - row pass: each thread takes a band of rows and scans each of them on its own, with parallel_prefix_sum on one
+       thread, so the parallelism of this pass is across rows rather than within a row,
+     - column pass: each thread takes a band of TILE_COLS-wide column tiles and sweeps each tile from top to bottom,
+       adding the row above to the current row, so that the inner loop runs along contiguous memory.
+     @param grid Row-major grid of num_rows * num_cols integers.
+     @param num_rows Number of rows of the grid.
+     @param num_cols Number of columns of the grid.
+     @param num_threads Number of concurrent threads used to build the table.
+     */
+    SummedAreaTable(const std::vector<int64_t>& grid, uint32_t num_rows, uint32_t num_cols, uint32_t num_threads) :
+    num_rows{num_rows},
+    num_cols{num_cols},
+    stride{num_cols + 1},
+    table(uint64_t(num_rows + 1) * (num_cols + 1), 0)
+    {
+        const uint32_t row_threads = clamp_num_threads(num_rows, num_threads);
+        run_workers(row_threads, [&](uint32_t pid) {
+            const auto range = chunk_range(pid, num_rows, row_threads);
+            for (uint64_t i = range.first; i < range.second; ++i) {
+                int64_t* row = &table[(i + 1) * stride + 1];
+                std::copy(&grid[i * num_cols], &grid[i * num_cols] + num_cols, row);
+                parallel_prefix_sum(row, num_cols, 1);
+            }
+        });
+
+        const uint32_t num_tiles = (num_cols + TILE_COLS - 1) / TILE_COLS;
+        const uint32_t tile_threads = clamp_num_threads(num_tiles, num_threads);
+        run_workers(tile_threads, [&](uint32_t pid) {
+            const auto range = chunk_range(pid, num_tiles, tile_threads);
+            for (uint64_t tile = range.first; tile < range.second; ++tile) {
+                const uint64_t col_begin = 1 + tile * TILE_COLS;
+                const uint64_t col_end = std::min<uint64_t>(col_begin + TILE_COLS, stride);
+                for (uint64_t i = 2; i <= num_rows; ++i) {
+                    int64_t* row = &table[i * stride];
+                    const int64_t* previous_row = row - stride;
+                    for (uint64_t j = col_begin; j < col_end; ++j) {
+                        row[j] += previous_row[j];
+                    }
+                }
+            }
+        });
+    }
+
+    /**
+     Sum of the grid cells in a rectangle.
+     @param rect Rectangle within the grid; an empty rectangle sums to zero.
+     @return Sum of the cells in rect.
+     */
+    int64_t query(const Rectangle& rect) const {
+        return at(rect.row_end, rect.col_end) - at(rect.row_begin, rect.col_end)
+             - at(rect.row_end, rect.col_begin) + at(rect.row_begin, rect.col_begin);
+    }
+
+    /**
+     Answers a batch of rectangle queries across threads.
+     @param rects Rectangles to sum.
+     @param sums Resized to rects.size() and filled with the sums.
+     @param num_threads Number of concurrent threads.
+     */
+    void query_batch(const std::vector<Rectangle>& rects, std::vector<int64_t>& sums, uint32_t num_threads) const {
+        parallel_query_batch(*this, rects, sums, num_threads);
+    }
+
+    /**
+     Sum of the rectangle [0, row) x [0, col).
+     */
+    int64_t at(uint32_t row, uint32_t col) const {
+        return table[uint64_t(row) * stride + col];
+    }
+
+private:
+
+    const uint32_t num_rows;
+    const uint32_t num_cols;
+    const uint64_t stride;
+    std::vector<int64_t> table;
+};
+
+
+/**
+ Two-dimensional binary indexed (Fenwick) tree over a row-major grid, for rectangle queries interleaved with point
+ updates.  Cell (i, j) of the tree, 1-indexed, holds the sum of the grid cells in rows (i - lowbit(i), i] and columns
+ (j - lowbit(j), j].
+ */
+class FenwickTree2D {
+
+public:
+
+    /**
+     One entry of a mixed batch: either a point update or a rectangle query.
+     */
+    struct Operation {
+        bool is_update;
+        uint32_t row;
+        uint32_t col;
+        int64_t delta;
+        Rectangle rect;
+    };
+
+    /**
+     Constructor.  Builds the tree in O(rows * cols) time instead of inserting cells one at a time: each cell pushes its
+     value to its Fenwick parent, first along every row (threads take bands of rows), then along every column (threads
+     take bands of TILE_COLS-wide column tiles, and the inner loop adds one contiguous row segment to another).
+     @param grid Row-major grid of num_rows * num_cols integers.
+     @param num_rows Number of rows of the grid.
+     @param num_cols Number of columns of the grid.
+     @param num_threads Number of concurrent threads used to build the tree.
+     */
+    FenwickTree2D(const std::vector<int64_t>& grid, uint32_t num_rows, uint32_t num_cols, uint32_t num_threads) :
+    num_rows{num_rows},
+    num_cols{num_cols},
+    stride{num_cols + 1},
+    tree(uint64_t(num_rows + 1) * (num_cols + 1), 0)
+    {
+        const uint32_t row_threads = clamp_num_threads(num_rows, num_threads);
+        run_workers(row_threads, [&](uint32_t pid) {
+            const auto range = chunk_range(pid, num_rows, row_threads);
+            for (uint64_t i = range.first; i < range.second; ++i) {
+                int64_t* row = &tree[(i + 1) * stride];
+                std::copy(&grid[i * num_cols], &grid[i * num_cols] + num_cols, row + 1);
+                for (uint64_t j = 1; j <= num_cols; ++j) {
+                    const uint64_t parent = j + (j & (~j + 1));
+                    if (parent <= num_cols) {
+                        row[parent] += row[j];
+                    }
+                }
+            }
+        });
+
+        const uint32_t num_tiles = (num_cols + TILE_COLS - 1) / TILE_COLS;
+        const uint32_t tile_threads = clamp_num_threads(num_tiles, num_threads);
+        run_workers(tile_threads, [&](uint32_t pid) {
+            const auto range = chunk_range(pid, num_tiles, tile_threads);
+            for (uint64_t tile = range.first; tile < range.second; ++tile) {
+                const uint64_t col_begin = 1 + tile * TILE_COLS;
+                const uint64_t col_end = std::min<uint64_t>(col_begin + TILE_COLS, stride);
+                for (uint64_t i = 1; i <= num_rows; ++i) {
+                    const uint64_t parent = i + (i & (~i + 1));
+                    if (parent > num_rows) {
+                        continue;
+                    }
+                    int64_t* parent_row = &tree[parent * stride];
+                    const int64_t* row = &tree[i * stride];
+                    for (uint64_t j = col_begin; j < col_end; ++j) {
+                        parent_row[j] += row[j];
+                    }
+                }
+            }
+        });
+    }
+
+    /**
+     Adds delta to one grid cell.
+     @param row Row of the cell, 0-indexed.
+     @param col Column of the cell, 0-indexed.
+     @param delta Value to add.
+     */
+    void update(uint32_t row, uint32_t col, int64_t delta) {
+        for (uint64_t i = uint64_t(row) + 1; i <= num_rows; i += i & (~i + 1)) {
+            for (uint64_t j = uint64_t(col) + 1; j <= num_cols; j += j & (~j + 1)) {
+                tree[i * stride + j] += delta;
+            }
+        }
+    }
+
+    /**
+     Sum of the rectangle [0, row) x [0, col).
+     */
+    int64_t prefix(uint32_t row, uint32_t col) const {
+        int64_t sum = 0;
+        for (uint64_t i = row; i > 0; i -= i & (~i + 1)) {
+            for (uint64_t j = col; j > 0; j -= j & (~j + 1)) {
+                sum += tree[i * stride + j];
+            }
+        }
+        return sum;
+    }
+
+    /**
+     Sum of the grid cells in a rectangle, reflecting every update so far.
+     @param rect Rectangle within the grid; an empty rectangle sums to zero.
+     @return Sum of the cells in rect.
+     */
+    int64_t query(const Rectangle& rect) const {
+        return prefix(rect.row_end, rect.col_end) - prefix(rect.row_begin, rect.col_end)
+             - prefix(rect.row_end, rect.col_begin) + prefix(rect.row_begin, rect.col_begin);
+    }
+
+    /**
+     Answers a batch of rectangle queries across threads.
+     @param rects Rectangles to sum.
+     @param sums Resized to rects.size() and filled with the sums.
+     @param num_threads Number of concurrent threads.
+     */
+    void query_batch(const std::vector<Rectangle>& rects, std::vector<int64_t>& sums, uint32_t num_threads) const {
+        parallel_query_batch(*this, rects, sums, num_threads);
+    }
+
+    /**
+     Applies a mixed batch of updates and queries with the same results as applying them one at a time in order.
+     Updates are applied sequentially; each run of consecutive queries between two updates is answered across threads
+     if it has at least QUERY_GRAIN queries per thread, and on the calling thread otherwise.
+     @param operations Updates and queries, in order.
+     @param sums Filled with the result of every query, in order.
+     @param num_threads Number of concurrent threads.
+     */
+    void apply_batch(const std::vector<Operation>& operations, std::vector<int64_t>& sums, uint32_t num_threads) {
+        sums.clear();
+        sums.reserve(operations.size());
+        uint64_t begin = 0;
+        while (begin < operations.size()) {
+            if (operations[begin].is_update) {
+                update(operations[begin].row, operations[begin].col, operations[begin].delta);
+                ++begin;
+                continue;
+            }
+            uint64_t end = begin;
+            while (end < operations.size() && !operations[end].is_update) {
+                ++end;
+            }
+            // the queries [begin, end) go straight from the operations into sums, without copying the rectangles
+            const uint64_t offset = sums.size();
+            sums.resize(offset + (end - begin));
+            const uint32_t run_threads = clamp_num_threads((end - begin) / QUERY_GRAIN, num_threads);
+            run_workers(run_threads, [&](uint32_t pid) {
+                const auto range = chunk_range(pid, end - begin, run_threads);
+                for (uint64_t i = range.first; i < range.second; ++i) {
+                    sums[offset + i] = query(operations[begin + i].rect);
+                }
+            });
+            begin = end;
+        }
+    }
+
+private:
+
+    const uint32_t num_rows;
+    const uint32_t num_cols;
+    const uint64_t stride;
+    std::vector<int64_t> tree;
+};
+
+
+/**
+ Builds the reference summed-area table with ParallelPrefixSum: the prefix sum of every row, then of every column of
+ the result.
+ @return Row-major num_rows * num_cols table whose entry (i, j) is the sum of [0, i] x [0, j].
+ */
+std::vector<int64_t> reference_summed_area_table(const std::vector<int64_t>& grid, uint32_t num_rows,
+                                                 uint32_t num_cols, uint32_t num_threads) {
+    std::vector<int64_t> result(grid);
+    for (uint32_t i = 0; i < num_rows; ++i) {
+        std::vector<int64_t> row(&result[uint64_t(i) * num_cols], &result[uint64_t(i) * num_cols] + num_cols);
+        ParallelPrefixSum pps(row, std::min(num_threads, num_cols));
+        pps.run_parallel();
+        std::copy(pps.get_nums().begin(), pps.get_nums().end(), &result[uint64_t(i) * num_cols]);
+    }
+    for (uint32_t j = 0; j < num_cols; ++j) {
+        std::vector<int64_t> column(num_rows);
+        for (uint32_t i = 0; i < num_rows; ++i) {
+            column[i] = result[uint64_t(i) * num_cols + j];
+        }
+        ParallelPrefixSum pps(column, std::min(num_threads, num_rows));
+        pps.run_parallel();
+        for (uint32_t i = 0; i < num_rows; ++i) {
+            result[uint64_t(i) * num_cols + j] = pps.get_nums()[i];
+        }
+    }
+    return result;
+}
+
+/**
+ Draws the q-th random rectangle of the stream of seed, possibly empty, inside a num_rows x num_cols grid.
+ It depends on (seed, q) only, so rectangles can be drawn in parallel.
+ */
+Rectangle random_rectangle(uint64_t seed, uint64_t q, uint32_t num_rows, uint32_t num_cols) {
+    uint32_t r0 = random_below(seed, 4 * q, num_rows + 1);
+    uint32_t r1 = random_below(seed, 4 * q + 1, num_rows + 1);
+    uint32_t c0 = random_below(seed, 4 * q + 2, num_cols + 1);
+    uint32_t c1 = random_below(seed, 4 * q + 3, num_cols + 1);
+    return Rectangle{std::min(r0, r1), std::min(c0, c1), std::max(r0, r1), std::max(c0, c1)};
+}
+
+
+/**
+ Runs num_operations random operations, one update in about update_period, on copies of fenwick, one at a time and with
+ apply_batch, and checks both against each other and against a summed-area table of the updated grid.
+ @param update_period Expected number of operations per update, and so the expected length of a run of queries.
+ @return Whether the results are correct.
+ */
+bool benchmark_mixed_operations(const FenwickTree2D& fenwick, const std::vector<int64_t>& grid, uint32_t num_rows,
+                                uint32_t num_cols, uint32_t num_operations, uint32_t update_period, uint32_t num_threads) {
+    std::vector<FenwickTree2D::Operation> operations(num_operations);
+    parallel_fill_ranges(num_operations, num_threads, [&](long long first, long long last) {
+        for (long long q = first; q < last; ++q) {
+            auto& operation = operations[q];
+            operation.is_update = random_below(DEFAULT_RANDOM_SEED + 2, 4 * q, update_period) == 0;
+            operation.row = random_below(DEFAULT_RANDOM_SEED + 2, 4 * q + 1, num_rows);
+            operation.col = random_below(DEFAULT_RANDOM_SEED + 2, 4 * q + 2, num_cols);
+            operation.delta = static_cast<int64_t>(random_below(DEFAULT_RANDOM_SEED + 2, 4 * q + 3, 21)) - 10;
+            operation.rect = random_rectangle(DEFAULT_RANDOM_SEED + 3, q, num_rows, num_cols);
+        }
+    });
+    std::cout << num_operations << " mixed operations, one update in " << update_period << ":" << std::endl;
+
+    FenwickTree2D check_fenwick(fenwick);
+    std::vector<int64_t> check_sums;
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& operation : operations) {
+        if (operation.is_update) {
+            check_fenwick.update(operation.row, operation.col, operation.delta);
+        }
+        else {
+            check_sums.push_back(check_fenwick.query(operation.rect));
+        }
+    }
+    const double one_at_a_time_time = seconds_since(start);
+    FenwickTree2D batched_fenwick(fenwick);
+    std::vector<int64_t> sums;
+    start = std::chrono::steady_clock::now();
+    batched_fenwick.apply_batch(operations, sums, num_threads);
+    const double batched_time = seconds_since(start);
+    std::cout << "One at a time: " << one_at_a_time_time << " seconds." << std::endl;
+    std::cout << "Batched: " << batched_time << " seconds." << std::endl;
+    std::cout << "Speedup: " << one_at_a_time_time / batched_time << "." << std::endl;
+
+    std::vector<int64_t> updated_grid(grid);
+    for (const auto& operation : operations) {
+        if (operation.is_update) {
+            updated_grid[uint64_t(operation.row) * num_cols + operation.col] += operation.delta;
+        }
+    }
+    SummedAreaTable updated_sat(updated_grid, num_rows, num_cols, num_threads);
+    bool correct = sums == check_sums;
+    for (uint32_t q = 0; q < num_operations && correct; q += 64) {
+        correct = batched_fenwick.query(operations[q].rect) == updated_sat.query(operations[q].rect);
+    }
+    std::cout << "Mixed results are " << (correct ? "" : "in") << "correct." << std::endl;
+    std::cout << "============================================" << std::endl;
+    return correct;
+}
+
+
+/**
+ Usage: summed_area_table.exe [log2 of the grid side] [number of threads]
+ - Build the summed-area table sequentially and in parallel and check it against ParallelPrefixSum.
+ - Answer a batch of random rectangle queries sequentially and across threads and check a sample by brute force.
+ - Build the Fenwick tree, check it against the summed-area table, and run a mixed batch of updates and queries.
+ */
+int main(int argc, const char * argv[]) {
+    const uint32_t log_side = argc > 1 ? static_cast<uint32_t>(std::stoul(argv[1])) : 11;
+    const uint32_t num_threads = argc > 2 ? static_cast<uint32_t>(std::stoul(argv[2]))
+                                          : std::max(1u, std::thread::hardware_concurrency());
+    const uint32_t num_rows = 1 << log_side;
+    const uint32_t num_cols = 1 << log_side;
+    const uint32_t num_queries = 1 << 20;
+    std::cout << "number of threads: " << num_threads << std::endl;
+    std::cout << "grid: " << num_rows << " x " << num_cols << std::endl;
+
+    std::vector<int64_t> grid(uint64_t(num_rows) * num_cols);
+    random_fill_integers(grid.data(), grid.size(), 0, 10, DEFAULT_RANDOM_SEED, num_threads);
+
+    auto start = std::chrono::steady_clock::now();
+    SummedAreaTable sequential_sat(grid, num_rows, num_cols, 1);
+    const double sequential_time = seconds_since(start);
+    start = std::chrono::steady_clock::now();
+    SummedAreaTable sat(grid, num_rows, num_cols, num_threads);
+    const double parallel_time = seconds_since(start);
+    std::cout << "Sequential build: " << sequential_time << " seconds." << std::endl;
+    std::cout << "Parallel build: " << parallel_time << " seconds." << std::endl;
+    std::cout << "Speedup: " << sequential_time / parallel_time << "." << std::endl;
+
+    const auto reference = reference_summed_area_table(grid, num_rows, num_cols, num_threads);
+    bool correct = true;
+    for (uint32_t i = 0; i < num_rows && correct; ++i) {
+        for (uint32_t j = 0; j < num_cols && correct; ++j) {
+            correct = sat.at(i + 1, j + 1) == reference[uint64_t(i) * num_cols + j]
+                   && sequential_sat.at(i + 1, j + 1) == reference[uint64_t(i) * num_cols + j];
+        }
+    }
+    std::cout << "Table is " << (correct ? "" : "in") << "correct." << std::endl;
+    std::cout << "============================================" << std::endl;
+
+    std::vector<Rectangle> rects(num_queries);
+    parallel_fill_ranges(num_queries, num_threads, [&](long long first, long long last) {
+        for (long long q = first; q < last; ++q) {
+            rects[q] = random_rectangle(DEFAULT_RANDOM_SEED + 1, q, num_rows, num_cols);
+        }
+    });
+    std::vector<int64_t> sequential_sums(num_queries);
+    start = std::chrono::steady_clock::now();
+    for (uint32_t q = 0; q < num_queries; ++q) {
+        sequential_sums[q] = sat.query(rects[q]);
+    }
+    const double sequential_query_time = seconds_since(start);
+    std::vector<int64_t> sums;
+    start = std::chrono::steady_clock::now();
+    sat.query_batch(rects, sums, num_threads);
+    const double parallel_query_time = seconds_since(start);
+    std::cout << num_queries << " sequential queries: " << sequential_query_time << " seconds." << std::endl;
+    std::cout << num_queries << " batched queries: " << parallel_query_time << " seconds." << std::endl;
+    correct = sums == sequential_sums;
+    for (uint32_t q = 0; q < 64 && correct; ++q) {
+        int64_t brute_force = 0;
+        for (uint32_t i = rects[q].row_begin; i < rects[q].row_end; ++i) {
+            for (uint32_t j = rects[q].col_begin; j < rects[q].col_end; ++j) {
+                brute_force += grid[uint64_t(i) * num_cols + j];
+            }
+        }
+        correct = brute_force == sums[q];
+    }
+    std::cout << "Queries are " << (correct ? "" : "in") << "correct." << std::endl;
+    std::cout << "============================================" << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    FenwickTree2D fenwick(grid, num_rows, num_cols, num_threads);
+    std::cout << "Fenwick tree build: " << seconds_since(start) << " seconds." << std::endl;
+    std::vector<int64_t> fenwick_sums;
+    start = std::chrono::steady_clock::now();
+    fenwick.query_batch(rects, fenwick_sums, num_threads);
+    std::cout << num_queries << " batched Fenwick queries: " << seconds_since(start) << " seconds." << std::endl;
+    std::cout << "Fenwick queries are " << (fenwick_sums == sums ? "" : "in") << "correct." << std::endl;
+    std::cout << "============================================" << std::endl;
+
+    // runs of about 100 queries between updates are answered on the calling thread, runs of about 10000 across threads
+    benchmark_mixed_operations(fenwick, grid, num_rows, num_cols, num_queries, 100, num_threads);
+    benchmark_mixed_operations(fenwick, grid, num_rows, num_cols, num_queries, 10000, num_threads);
+    return 0;
+}